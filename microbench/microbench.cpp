@@ -0,0 +1,451 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+// Microbenchmarks for hot engine primitives. Every primitive is timed over a fixed
+// corpus of positions, with a warm-up pass and several repetitions. The median
+// time per operation is reported, so that optimizations can be validated in isolation.
+// Usage: ./microbench [filter]
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+
+#include "../src/types.hpp"
+#include "../src/board.hpp"
+#include "../src/movegen.hpp"
+#include "../src/movepick.hpp"
+#include "../src/evaluate.hpp"
+#include "../src/hashkeys.hpp"
+#include "../src/bitboards.hpp"
+#include "../src/search.hpp"
+#include "../src/thread.hpp"
+#include "../src/uci.hpp"
+
+// Positions from different game phases; the last ones are in check for the evasion generator
+static const std::string CORPUS_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q2/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "2kr1b1r/1pp2pp1/p1n1bq2/P2pp3/1P2Pn1p/2PP1N1P/1BQN1PP1/R3KB1R b KQ - 2 12",
+    "r4rk1/ppqb2pp/n2bp3/5p2/3B4/2PB1N2/PPQ2PPP/3RK2R b K - 0 12",
+    "r1bq1rk1/pp2nppp/2n1p3/3pP3/2pP4/P1P2N2/2P2PPP/R1BQKB1R w KQ - 1 9",
+    "rnbqkb1r/pp1p1ppp/4pn2/2p5/2PP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 0 4",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3r1k1/p4ppp/2p5/3b4/8/1P3N2/P4PPP/3R1RK1 w - - 0 21",
+    "8/8/4k3/3p4/3P4/4K3/8/8 w - - 0 1",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 b - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbqkbnr/ppp2ppp/8/1B1pp3/4P3/8/PPPP1PPP/RNBQK1NR b KQkq - 1 3",
+    "4k3/8/8/8/8/8/4q3/4K3 w - - 0 1"
+};
+
+static std::vector<Board> corpus;
+
+// Move lists of the corpus positions are generated once, so that they are not part of the timings
+static std::vector<MoveList> legalMoves, pseudoLegalMoves, captures;
+
+// Prevents the compiler from optimizing away the measured work
+static volatile uint64_t sink;
+
+struct Measurement {
+
+    std::string name;
+    uint64_t operations;
+    double median;
+    double minimum;
+
+};
+
+// Runs a benchmark function a number of times and returns the median and minimum time per operation.
+// The function returns the number of operations it performed. The optional setup function is
+// executed before every repetition and is not part of the timing.
+static Measurement measure(const std::string& name, const std::function<uint64_t()>& run, const std::function<void()>& setup = nullptr) {
+
+    constexpr unsigned WarmupRuns = 3;
+    constexpr unsigned Repetitions = 15;
+    constexpr double MinimumDuration = 20e6; // Nanoseconds per repetition
+
+    for (unsigned i = 0; i < WarmupRuns; i++) {
+        if (setup) {
+            setup();
+        }
+        run();
+    }
+
+    // Determine how many times the function has to run for a reliable measurement
+    unsigned iterations = 1;
+
+    while (true) {
+        double elapsed = 0;
+        for (unsigned i = 0; i < iterations; i++) {
+            if (setup) {
+                setup();
+            }
+            auto start = std::chrono::steady_clock::now();
+            run();
+            elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (elapsed >= MinimumDuration || iterations >= (1u << 20)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    uint64_t operations = 0;
+
+    for (unsigned r = 0; r < Repetitions; r++) {
+        double elapsed = 0;
+        uint64_t total = 0;
+        for (unsigned i = 0; i < iterations; i++) {
+            if (setup) {
+                setup();
+            }
+            auto start = std::chrono::steady_clock::now();
+            operations = run();
+            elapsed += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            total += operations;
+        }
+        samples.push_back(elapsed / std::max(total, uint64_t(1)));
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    return { name, operations, samples[samples.size() / 2], samples.front() };
+
+}
+
+template<MoveGenerationType T, MoveLegality L>
+static uint64_t run_generate_moves() {
+
+    uint64_t count = 0, operations = 0;
+
+    for (const Board& board : corpus) {
+        // Evasions are only generated for positions in check and vice versa
+        if ((T == EVASION) != bool(board.checkers())) {
+            continue;
+        }
+        count += generate_moves<T, L>(board, board.turn()).size();
+        operations++;
+    }
+
+    sink = count;
+    return operations;
+
+}
+
+// Enable or disable the attack maps and bring the maps of the corpus positions up to date
+static void set_attack_maps(const bool enabled) {
+
+    AttackMaps::set_enabled(enabled);
+
+    for (Board& board : corpus) {
+        board.refresh_attack_map();
+    }
+
+}
+
+// Measures a benchmark function with attack maps enabled
+static Measurement measure_with_attack_maps(const std::string& name, const std::function<uint64_t()>& run) {
+
+    set_attack_maps(true);
+    const Measurement measurement = measure(name, run);
+    set_attack_maps(false);
+
+    return measurement;
+
+}
+
+static uint64_t run_do_undo_move() {
+
+    uint64_t operations = 0;
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+        Board& board = corpus[i];
+        const MoveList& moves = legalMoves[i];
+        for (const Move move : moves) {
+            board.do_move(move);
+            board.undo_move();
+        }
+        operations += moves.size();
+    }
+
+    return operations;
+
+}
+
+static uint64_t run_is_legal() {
+
+    uint64_t count = 0, operations = 0;
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+        const Board& board = corpus[i];
+        const MoveList& moves = pseudoLegalMoves[i];
+        for (const Move move : moves) {
+            count += board.is_legal(move);
+        }
+        operations += moves.size();
+    }
+
+    sink = count;
+    return operations;
+
+}
+
+static uint64_t run_gives_check() {
+
+    uint64_t count = 0, operations = 0;
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+        Board& board = corpus[i];
+        const MoveList& moves = legalMoves[i];
+        for (const Move move : moves) {
+            count += board.gives_check(move);
+        }
+        operations += moves.size();
+    }
+
+    sink = count;
+    return operations;
+
+}
+
+static uint64_t run_see() {
+
+    uint64_t count = 0, operations = 0;
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+        const Board& board = corpus[i];
+        const MoveList& moves = captures[i];
+        for (const Move move : moves) {
+            count += board.see(move);
+        }
+        operations += moves.size();
+    }
+
+    sink = count;
+    return operations;
+
+}
+
+static uint64_t run_see_ge() {
+
+    uint64_t count = 0, operations = 0;
+
+    for (unsigned i = 0; i < corpus.size(); i++) {
+        const Board& board = corpus[i];
+        const MoveList& moves = captures[i];
+        for (const Move move : moves) {
+            count += board.see_ge(move, 0);
+        }
+        operations += moves.size();
+    }
+
+    sink = count;
+    return operations;
+
+}
+
+static uint64_t run_evaluate() {
+
+    int64_t sum = 0;
+
+    for (const Board& board : corpus) {
+        sum += evaluate(board, 0);
+    }
+
+    sink = sum;
+    return corpus.size();
+
+}
+
+static uint64_t run_set_fen(const std::vector<std::string>& fens) {
+
+    Board board;
+    uint64_t sum = 0;
+
+    for (const std::string& fen : fens) {
+        board.set_fen(fen);
+        sum += board.hashkey();
+    }
+
+    sink = sum;
+    return fens.size();
+
+}
+
+static uint64_t run_from_packed(const std::vector<PackedPosition>& positions) {
+
+    Board board;
+    uint64_t sum = 0;
+
+    for (const PackedPosition& position : positions) {
+        board.from_packed(position);
+        sum += board.hashkey();
+    }
+
+    sink = sum;
+    return positions.size();
+
+}
+
+// Pseudo random keys for the transposition table, spread over the whole table
+static std::vector<uint64_t> random_keys(const unsigned count) {
+
+    std::vector<uint64_t> keys;
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+    for (unsigned i = 0; i < count; i++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        keys.push_back(seed);
+    }
+
+    return keys;
+
+}
+
+static uint64_t run_tt_store(const std::vector<uint64_t>& keys) {
+
+    for (const uint64_t key : keys) {
+        TTable.store(key, 5, 100, 50, MOVE_NONE, BOUND_EXACT);
+    }
+
+    return keys.size();
+
+}
+
+static uint64_t run_tt_probe(const std::vector<uint64_t>& keys) {
+
+    uint64_t hits = 0;
+    bool ttHit;
+
+    for (const uint64_t key : keys) {
+        TTable.probe(key, ttHit);
+        hits += ttHit;
+    }
+
+    sink = hits;
+    return keys.size();
+
+}
+
+static uint64_t run_movepicker(SearchStackArray& stack, const HistoryTable& history, const CaptureHistoryTable& captureHistory, const CounterMoveTable& counterMove) {
+
+    uint64_t operations = 0;
+
+    for (const Board& board : corpus) {
+        MovePicker picker(board, stack.root(), &history, &captureHistory, counterMove, MOVE_NONE);
+        while (picker.pick() != MOVE_NONE) {
+            operations++;
+        }
+    }
+
+    return operations;
+
+}
+
+int main(int argc, char* argv[]) {
+
+    Hash::init();
+    Bitboards::init();
+    Eval::init();
+    Search::init();
+
+    TTable.set_size(HashOption.get_default());
+
+    const std::string filter = argc > 1 ? argv[1] : "";
+
+    for (const std::string& fen : CORPUS_FENS) {
+        corpus.emplace_back();
+        corpus.back().set_fen(fen);
+        legalMoves.push_back(generate_moves<ALL, LEGAL>(corpus.back(), corpus.back().turn()));
+        pseudoLegalMoves.push_back(generate_moves<ALL, PSEUDO_LEGAL>(corpus.back(), corpus.back().turn()));
+        captures.push_back(generate_moves<CAPTURE, PSEUDO_LEGAL>(corpus.back(), corpus.back().turn()));
+    }
+
+    Thread* thread = Threads.get_thread(0);
+
+    SearchStackArray stack;
+    HistoryTable history;
+    CaptureHistoryTable captureHistory;
+    CounterMoveTable counterMove;
+    stack.clear(thread->continuationHistory.sentinel());
+    history.clear();
+    counterMove.clear();
+
+    const std::vector<uint64_t> keys = random_keys(1 << 16);
+
+    std::vector<std::string> fens;
+    std::vector<PackedPosition> packed;
+    for (const Board& board : corpus) {
+        fens.push_back(board.get_fen());
+        packed.push_back(board.to_packed());
+    }
+
+    const std::vector<std::pair<std::string, std::function<Measurement(const std::string&)>>> benchmarks = {
+        { "do_move/undo_move",          [](const std::string& n) { return measure(n, run_do_undo_move); } },
+        { "do_move/undo_move (maps)",   [](const std::string& n) { return measure_with_attack_maps(n, run_do_undo_move); } },
+        { "generate_moves<QUIET>",      [](const std::string& n) { return measure(n, run_generate_moves<QUIET, PSEUDO_LEGAL>); } },
+        { "generate_moves<CAPTURE>",    [](const std::string& n) { return measure(n, run_generate_moves<CAPTURE, PSEUDO_LEGAL>); } },
+        { "generate_moves<EVASION>",    [](const std::string& n) { return measure(n, run_generate_moves<EVASION, PSEUDO_LEGAL>); } },
+        { "generate_moves<ALL>",        [](const std::string& n) { return measure(n, run_generate_moves<ALL, PSEUDO_LEGAL>); } },
+        { "generate_moves<ALL, LEGAL>", [](const std::string& n) { return measure(n, run_generate_moves<ALL, LEGAL>); } },
+        { "is_legal",                   [](const std::string& n) { return measure(n, run_is_legal); } },
+        { "is_legal (maps)",            [](const std::string& n) { return measure_with_attack_maps(n, run_is_legal); } },
+        { "gives_check",                [](const std::string& n) { return measure(n, run_gives_check); } },
+        { "see",                        [](const std::string& n) { return measure(n, run_see); } },
+        { "see (maps)",                 [](const std::string& n) { return measure_with_attack_maps(n, run_see); } },
+        { "see_ge",                     [](const std::string& n) { return measure(n, run_see_ge); } },
+        { "see_ge (maps)",              [](const std::string& n) { return measure_with_attack_maps(n, run_see_ge); } },
+        { "evaluate (cold tables)",     [&](const std::string& n) { return measure(n, run_evaluate, [&] { thread->pawnTable.clear(); thread->evalCache.clear(); }); } },
+        { "evaluate (warm tables)",     [&](const std::string& n) { return measure(n, run_evaluate, [&] { thread->evalCache.clear(); }); } },
+        { "evaluate (cached)",          [](const std::string& n) { return measure(n, run_evaluate); } },
+        { "Board::set_fen",             [&](const std::string& n) { return measure(n, [&] { return run_set_fen(fens); }); } },
+        { "Board::from_packed",         [&](const std::string& n) { return measure(n, [&] { return run_from_packed(packed); }); } },
+        { "TTable.store",               [&](const std::string& n) { return measure(n, [&] { return run_tt_store(keys); }); } },
+        { "TTable.probe",               [&](const std::string& n) { return measure(n, [&] { return run_tt_probe(keys); }); } },
+        { "MovePicker::pick",           [&](const std::string& n) { return measure(n, [&] { return run_movepicker(stack, history, captureHistory, counterMove); }); } }
+    };
+
+    std::cout << std::left << std::setw(30) << "Primitive" << std::right
+              << std::setw(12) << "Ops/run" << std::setw(14) << "Median ns/op" << std::setw(12) << "Min ns/op" << std::endl;
+
+    for (const auto& benchmark : benchmarks) {
+
+        if (benchmark.first.find(filter) == std::string::npos) {
+            continue;
+        }
+
+        const Measurement m = benchmark.second(benchmark.first);
+
+        std::cout << std::left << std::setw(30) << m.name << std::right
+                  << std::setw(12) << m.operations
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(14) << m.median << std::setw(12) << m.minimum << std::endl;
+
+    }
+
+    return 0;
+
+}
@@ -0,0 +1,225 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+#include "analyze.hpp"
+#include "dataset.hpp"
+#include "io.hpp"
+#include "thread.hpp"
+#include "timeman.hpp"
+#include "uci.hpp"
+
+// Parse the arguments of the analyze command: the input file, the search limits
+// (depth, nodes or movetime), the optional number of threads and the output file
+bool parse_analysis_settings(std::stringstream& ss, AnalysisSettings& settings) {
+
+    std::vector<std::string> arguments;
+    std::string word;
+
+    while (ss >> word) {
+        arguments.push_back(word);
+    }
+
+    if (arguments.size() < 2) {
+        UCI::send_string("Error: usage is analyze <epdfile> <limits> <outfile>");
+        return false;
+    }
+
+    if (arguments.size() % 2) {
+        UCI::send_string("Error: analysis limit without a value");
+        return false;
+    }
+
+    settings.input  = arguments.front();
+    settings.output = arguments.back();
+
+    try {
+        for (size_t i = 1; i + 2 < arguments.size(); i += 2) {
+            const std::string& name = arguments[i];
+            const std::string& value = arguments[i + 1];
+            if (name == "depth") {
+                settings.limits.depth = std::clamp(std::stoi(value), 1, DEPTH_MAX);
+            } else if (name == "nodes") {
+                settings.limits.nodes = std::max(std::stoll(value), 1ll);
+            } else if (name == "movetime") {
+                settings.limits.moveTime = std::max(std::stoll(value), 1ll);
+            } else if (name == "threads") {
+                settings.threads = std::clamp(std::stoi(value), ThreadsOption.get_min(), ThreadsOption.get_max());
+            } else {
+                UCI::send_string("Error: unknown analysis limit " + name);
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        UCI::send_string("Error: invalid numeric analysis argument");
+        return false;
+    }
+
+    if (settings.limits.depth == DEPTH_MAX && !settings.limits.nodes && !settings.limits.moveTime) {
+        UCI::send_string("Error: no depth, nodes or movetime limit given");
+        return false;
+    }
+
+    return true;
+
+}
+
+// Shared state of all threads analysing positions
+struct AnalysisState {
+
+    const AnalysisSettings& settings;
+    std::vector<std::string> lines;
+    std::ofstream output;
+    std::mutex mutex;
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> analysed{0};
+    std::atomic<uint64_t> skipped{0};
+    std::atomic<uint64_t> nodes{0};
+
+    explicit AnalysisState(const AnalysisSettings& s) : settings(s) {}
+
+};
+
+// Search the position of an EPD line. Returns false if the line holds no legal position
+static bool analyze_line(Thread& thread, AnalysisState& state, const size_t index) {
+
+    std::istringstream ss(state.lines[index]);
+    std::string fen;
+
+    if (!Dataset::parse_position(ss, fen)) {
+        return false;
+    }
+
+    Board board;
+    board.set_fen(fen);
+
+    if (!board.is_opponent_safe()) {
+        return false;
+    }
+
+    const SearchResult result = thread.search_alone(board, state.settings.limits);
+
+    // Results are written in the order the searches finish, the line number identifies the position
+    std::stringstream line;
+    line << fen
+         << " bestmove " << (result.bestMove != MOVE_NONE ? move_to_string(result.bestMove) : "none")
+         << "; score " << UCI::value_to_string(result.value)
+         << "; depth " << result.depth
+         << "; nodes " << result.nodes
+         << "; line " << index + 1 << ";\n";
+
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.output << line.str();
+        state.output.flush();
+    }
+
+    state.nodes += result.nodes;
+
+    return true;
+
+}
+
+// Take the next line from the input until all positions have been analysed or the pool is stopped
+static void analyze_thread(Thread& thread, AnalysisState& state) {
+
+    TimePoint lastReport = Clock::now();
+
+    for (size_t index = state.next++; index < state.lines.size() && !Threads.has_stopped(); index = state.next++) {
+
+        if (analyze_line(thread, state, index)) {
+            state.analysed++;
+        } else {
+            state.skipped++;
+        }
+
+        if (thread.get_index() == 0 && get_time_elapsed(lastReport) >= 10000) {
+            lastReport = Clock::now();
+            UCI::send_string("analyze positions " + std::to_string(state.analysed) + " of " + std::to_string(state.lines.size()));
+        }
+
+    }
+
+}
+
+// Analyse the positions of an EPD file with one independent single-threaded search per thread.
+// The threads share the transposition table, but every thread has its own board, histories,
+// pawn table and evaluation cache. Returns the number of analysed positions
+uint64_t analyze_positions(const AnalysisSettings& settings) {
+
+    AnalysisState state(settings);
+
+    std::ifstream input(settings.input);
+    if (!input.is_open()) {
+        UCI::send_string("Error: could not open " + settings.input);
+        return 0;
+    }
+
+    std::string line;
+    while (std::getline(input, line)) {
+        state.lines.push_back(line);
+    }
+
+    state.output.open(settings.output);
+    if (!state.output.is_open()) {
+        UCI::send_string("Error: could not open " + settings.output);
+        return 0;
+    }
+
+    Threads.resize(settings.threads);
+    Threads.reset();
+    TTable.clear();
+
+    const TimePoint start = Clock::now();
+
+    Threads.start_jobs([&state](Thread& thread) { analyze_thread(thread, state); });
+    Threads.wait_until_finished();
+    Threads.stop_searching();
+
+    const Duration elapsed = std::max(get_time_elapsed(start), Duration(1));
+
+    std::stringstream positionsPerSecond;
+    positionsPerSecond << std::fixed << std::setprecision(1) << state.analysed * 1000.0 / elapsed;
+
+    // Write out the queued progress lines before the summary
+    IO::flush();
+
+    std::cout << "Positions analysed:          " << std::setw(12) << state.analysed << std::endl;
+    std::cout << "Lines skipped:               " << std::setw(12) << state.skipped << std::endl;
+    std::cout << "Nodes searched:              " << std::setw(12) << state.nodes << std::endl;
+    std::cout << "Time elapsed (ms):           " << std::setw(12) << elapsed << std::endl;
+    std::cout << "Positions per second:        " << std::setw(12) << positionsPerSecond.str() << std::endl;
+    std::cout << "Nodes per second:            " << std::setw(12) << state.nodes * 1000 / elapsed << std::endl;
+
+    Threads.resize(ThreadsOption.get_value());
+
+    return state.analysed;
+
+}
@@ -0,0 +1,47 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef ANALYZE_H
+#define ANALYZE_H
+
+#include <sstream>
+#include <string>
+
+#include "types.hpp"
+#include "search.hpp"
+
+// Settings for analysing a file of EPD positions. Every thread of the pool searches
+// its own positions single-threaded, so the threads do not share a search tree
+struct AnalysisSettings {
+
+    std::string input;
+    std::string output;
+    SearchLimits limits; // Limits of the search of every single position
+    unsigned threads = 1;
+
+};
+
+extern bool parse_analysis_settings(std::stringstream& ss, AnalysisSettings& settings);
+extern uint64_t analyze_positions(const AnalysisSettings& settings);
+
+#endif
@@ -0,0 +1,164 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "attackmap.hpp"
+#include "board.hpp"
+
+#include <cstring>
+
+namespace AttackMaps {
+
+    static bool enabled = false;
+
+    bool is_enabled() {
+
+        return enabled;
+
+    }
+
+    void set_enabled(const bool e) {
+
+        enabled = e;
+
+    }
+
+    // Squares attacked by the piece on the given square, which must not be empty
+    static Bitboard piece_attacks_from(const Board& board, const Square sq) {
+
+        const Piecetype pt = board.piecetype(sq);
+
+        return pt == PAWN ? PawnAttacks[board.owner(sq)][sq] : piece_attacks(pt, sq, board.pieces(BOTH));
+
+    }
+
+    // Decrease the attacker counts of the squares which are no longer attacked by a piece and
+    // increase those of the newly attacked squares. The counts of all squares are added and
+    // subtracted at once, one binary digit after the other, until no square has a carry left
+    static void update_counts(Bitboard* counts, Bitboard removed, Bitboard added) {
+
+        for (unsigned i = 0; i < CountBits && removed; i++) {
+            const Bitboard borrow = removed & ~counts[i];
+            counts[i] ^= removed;
+            removed = borrow;
+        }
+
+        for (unsigned i = 0; i < CountBits && added; i++) {
+            const Bitboard carry = added & counts[i];
+            counts[i] ^= added;
+            added = carry;
+        }
+
+    }
+
+    // Compute the attack map of a board from scratch
+    void refresh(const Board& board, AttackMap& map) {
+
+        std::memset(&map, 0, sizeof(AttackMap));
+        std::memset(map.pieces, NoPiece, sizeof(map.pieces));
+
+        update(board, map, board.pieces(BOTH));
+
+    }
+
+    // Update the attack map of the previous position to the current position of the board,
+    // given the squares on which a piece was added, removed or replaced
+    void update(const Board& board, AttackMap& map, const Bitboard changed) {
+
+        const Bitboard occupied = board.pieces(BOTH);
+        const Bitboard diagonalSliders = board.pieces(BISHOP) | board.pieces(QUEEN);
+        const Bitboard straightSliders = board.pieces(ROOK)   | board.pieces(QUEEN);
+
+        // A slider only attacks other squares if a square on one of its rays has changed. Since
+        // the squares before the first changed square on the ray are the same, the slider still
+        // attacks that square, so looking for the sliders attacking a changed square is enough
+        Bitboard dirty = changed;
+        Bitboard squares = changed;
+        while (squares) {
+            const Square sq = pop_lsb(squares);
+            dirty |= (piece_attacks<BISHOP>(sq, occupied) & diagonalSliders)
+                   | (piece_attacks<ROOK>(sq, occupied)   & straightSliders);
+        }
+
+        // Pieces of which the combined attacks need to be recomputed, one bit for every piece
+        unsigned touched = 0;
+
+        while (dirty) {
+
+            const Square sq = pop_lsb(dirty);
+            const uint8_t piece = board.is_sq_empty(sq) ? NoPiece : uint8_t(PIECETYPE_COUNT * board.owner(sq) + board.piecetype(sq));
+            const Bitboard attacks = piece != NoPiece ? piece_attacks_from(board, sq) : 0;
+            const uint8_t previousPiece = map.pieces[sq];
+            const Bitboard previousAttacks = map.squareAttacks[sq];
+
+            if (piece == previousPiece) {
+                if (attacks == previousAttacks) {
+                    continue;
+                }
+                // Only the squares on the changed rays of the slider need new counts
+                update_counts(map.attackerCounts[piece / PIECETYPE_COUNT], previousAttacks & ~attacks, attacks & ~previousAttacks);
+            } else {
+                if (previousPiece != NoPiece) {
+                    update_counts(map.attackerCounts[previousPiece / PIECETYPE_COUNT], previousAttacks, 0);
+                }
+                if (piece != NoPiece) {
+                    update_counts(map.attackerCounts[piece / PIECETYPE_COUNT], 0, attacks);
+                }
+            }
+
+            touched |= (1 << piece) | (1 << previousPiece);
+            map.pieces[sq] = piece;
+            map.squareAttacks[sq] = attacks;
+
+        }
+
+        // Recombine the attacks of all piece types with changed attacks
+        for (Color c = WHITE; c < COLOR_COUNT; ++c) {
+
+            if (!((touched >> (PIECETYPE_COUNT * c)) & 0x3F)) {
+                continue;
+            }
+
+            for (Piecetype pt = PAWN; pt < PIECETYPE_COUNT; ++pt) {
+                if (touched & (1 << (PIECETYPE_COUNT * c + pt))) {
+                    Bitboard attacks = 0;
+                    if (pt == PAWN) {
+                        attacks = board.gen_pawns_attacks(c);
+                    } else {
+                        Bitboard pieces = board.pieces(c, pt);
+                        while (pieces) {
+                            attacks |= map.squareAttacks[pop_lsb(pieces)];
+                        }
+                    }
+                    map.pieceAttacks[c][pt] = attacks;
+                }
+            }
+
+            map.colorAttacks[c] = map.pieceAttacks[c][PAWN]   | map.pieceAttacks[c][KNIGHT]
+                                | map.pieceAttacks[c][BISHOP] | map.pieceAttacks[c][ROOK]
+                                | map.pieceAttacks[c][QUEEN]  | map.pieceAttacks[c][KING];
+
+        }
+
+    }
+
+}
@@ -0,0 +1,72 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef ATTACKMAP_H
+#define ATTACKMAP_H
+
+#include "types.hpp"
+
+class Board;
+
+// Incrementally updated attack maps
+//
+// The attack map stores the squares attacked by every piece on the board, the union of these
+// attacks for every piece type of both colors and the number of pieces of each color attacking
+// every square. Sliding attacks stop at the first piece in every direction, as on the board.
+// After a move, only the pieces on the changed squares and the sliders whose rays reach one of
+// the changed squares get their attacks recomputed.
+namespace AttackMaps {
+
+    // Stored for squares without a piece in the piece array of the map
+    static constexpr uint8_t NoPiece = 2 * PIECETYPE_COUNT;
+
+    // Number of binary digits of the attacker counts, enough for all 16 pieces of a color
+    static constexpr unsigned CountBits = 5;
+
+    struct alignas(64) AttackMap {
+        Bitboard squareAttacks[SQUARE_COUNT]; // Attacks of the piece on every square
+        Bitboard pieceAttacks[COLOR_COUNT][PIECETYPE_COUNT]; // Attacks by all pieces of a type
+        Bitboard colorAttacks[COLOR_COUNT]; // Attacks by all pieces of a color
+        Bitboard attackerCounts[COLOR_COUNT][CountBits]; // Number of pieces attacking a square, one bitboard per binary digit
+        uint8_t pieces[SQUARE_COUNT]; // Piece the attacks of a square belong to, PIECETYPE_COUNT * color + type
+    };
+
+    // Number of pieces of a color attacking a square
+    inline unsigned attacker_count(const AttackMap& map, const Color color, const Square sq) {
+        unsigned count = 0;
+        for (unsigned i = 0; i < CountBits; i++) {
+            count |= unsigned((map.attackerCounts[color][i] >> sq) & 1) << i;
+        }
+        return count;
+    }
+
+    // Attack maps are only kept up to date while they are enabled. This must not change during a search
+    bool is_enabled();
+    void set_enabled(const bool enabled);
+
+    void refresh(const Board& board, AttackMap& map);
+    void update(const Board& board, AttackMap& map, const Bitboard changed);
+
+}
+
+#endif
@@ -20,7 +20,14 @@
   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
   SOFTWARE.
 */
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+
+#include "bench.hpp"
+#include "perfcounters.hpp"
 #include "board.hpp"
+#include "io.hpp"
 #include "movegen.hpp"
 #include "uci.hpp"
 #include "search.hpp"
@@ -74,47 +81,797 @@ static std::string BENCHMARK_FENS[42] = {
 
 };
 
-// Runs a benchmark for 42 testing positions to retrieve a number of total visited
-// nodes. This number should stay consistent and can be used as a verification
-// of search/evaluation integrity
-uint64_t benchmark() {
+// Parses the arguments of the bench command in the form
+// bench <limit> <threads> <hashMB> <fenfile|default> <depth|nodes|movetime>
+//       [format text|json|csv] [trials <n>] [output <file>] [counters]
+// Missing positional arguments keep their default values
+bool parse_benchmark_settings(std::stringstream& ss, BenchmarkSettings& settings) {
+
+    std::vector<std::string> arguments;
+    std::string word;
+
+    try {
+        while (ss >> word) {
+            if (word == "format") {
+                ss >> word;
+                if (word == "text") {
+                    settings.format = FORMAT_TEXT;
+                } else if (word == "json") {
+                    settings.format = FORMAT_JSON;
+                } else if (word == "csv") {
+                    settings.format = FORMAT_CSV;
+                } else {
+                    UCI::send_string("Error: unknown bench format " + word);
+                    return false;
+                }
+            } else if (word == "trials") {
+                ss >> word;
+                settings.trials = std::max(std::stoi(word), 1);
+            } else if (word == "output") {
+                ss >> settings.output;
+            } else if (word == "counters") {
+                settings.counters = true;
+            } else {
+                arguments.push_back(word);
+            }
+        }
+
+        if (arguments.size() > 0) {
+            settings.limit = std::max(std::stoll(arguments[0]), 1ll);
+        }
+        if (arguments.size() > 1) {
+            settings.threads = std::clamp(std::stoi(arguments[1]), ThreadsOption.get_min(), ThreadsOption.get_max());
+        }
+        if (arguments.size() > 2) {
+            settings.hashSize = std::clamp(std::stoi(arguments[2]), HashOption.get_min(), HashOption.get_max());
+        }
+    } catch (const std::exception&) {
+        UCI::send_string("Error: invalid numeric bench argument");
+        return false;
+    }
+
+    if (arguments.size() > 3) {
+        settings.positions = arguments[3];
+    }
+
+    if (arguments.size() > 4) {
+        if (arguments[4] == "depth") {
+            settings.limitType = BENCH_DEPTH;
+        } else if (arguments[4] == "nodes") {
+            settings.limitType = BENCH_NODES;
+        } else if (arguments[4] == "movetime") {
+            settings.limitType = BENCH_MOVETIME;
+        } else {
+            UCI::send_string("Error: unknown bench limit type " + arguments[4]);
+            return false;
+        }
+    }
+
+    if (settings.limitType == BENCH_DEPTH) {
+        settings.limit = std::min(settings.limit, uint64_t(DEPTH_MAX));
+    }
+
+    return true;
+
+}
+
+// Reads the benchmark positions, either the built-in ones or one FEN/EPD per line from a file
+static std::vector<std::string> load_positions(const std::string& positions) {
+
+    std::vector<std::string> fens;
+
+    if (positions == "default") {
+        fens.assign(BENCHMARK_FENS, BENCHMARK_FENS + 42);
+        return fens;
+    }
+
+    std::ifstream file(positions);
+
+    if (!file.is_open()) {
+        UCI::send_string("Error: could not open position file " + positions);
+        return fens;
+    }
+
+    std::string line;
+
+    while (std::getline(file, line)) {
+        // Files with Windows line endings leave a carriage return at the end of every line
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        // Skip empty lines and comments
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') {
+            continue;
+        }
+        fens.push_back(line);
+    }
+
+    return fens;
+
+}
+
+// Per-position measurements of a single benchmark trial
+struct PositionResult {
+
+    uint64_t nodes;
+    Duration time;
+    uint64_t hashTableHits;
+    uint64_t hashTableProbes;
+    Depth selectiveDepth;
+    PerfCounts counters;
+    SearchStats stats;
+
+};
+
+typedef std::vector<PositionResult> TrialResult;
+
+static uint64_t trial_nodes(const TrialResult& trial) {
+
+    uint64_t nodes = 0;
+
+    for (const PositionResult& result : trial) {
+        nodes += result.nodes;
+    }
+
+    return nodes;
+
+}
+
+static Duration trial_time(const TrialResult& trial) {
+
+    Duration time = 0;
+
+    for (const PositionResult& result : trial) {
+        time += result.time;
+    }
+
+    return time;
+
+}
+
+static uint64_t nodes_per_second(const uint64_t nodes, const Duration time) {
+    return 1000 * nodes / std::max(time, Duration(1));
+}
+
+static std::string hash_table_hit_rate(const PositionResult& result) {
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(4)
+       << (result.hashTableProbes ? double(result.hashTableHits) / result.hashTableProbes : 0.0);
+
+    return ss.str();
+
+}
+
+// Hardware events per searched node, or n/a if the event is not supported
+static std::string per_node(const PositionResult& result, const PerfCounters& counters, const PerfEvent event) {
+
+    if (!counters.is_supported(event)) {
+        return "n/a";
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << double(result.counters[event]) / std::max(result.nodes, uint64_t(1));
+
+    return ss.str();
+
+}
+
+static std::string instructions_per_cycle(const PositionResult& result, const PerfCounters& counters) {
+
+    if (   !counters.is_supported(PERF_CYCLES)
+        || !counters.is_supported(PERF_INSTRUCTIONS)
+        || !result.counters[PERF_CYCLES]) {
+        return "n/a";
+    }
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2) << double(result.counters[PERF_INSTRUCTIONS]) / result.counters[PERF_CYCLES];
+
+    return ss.str();
+
+}
+
+// Sum of nodes and hardware events of all positions in a trial
+static PositionResult trial_total(const TrialResult& trial) {
+
+    PositionResult total = {};
+
+    for (const PositionResult& result : trial) {
+        total.nodes += result.nodes;
+        total.time += result.time;
+        for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+            total.counters[event] += result.counters[event];
+        }
+    }
+
+    return total;
+
+}
+
+static std::string limit_type_name(const BenchmarkLimitType limitType) {
+
+    switch (limitType) {
+        case BENCH_NODES:    return "nodes";
+        case BENCH_MOVETIME: return "movetime";
+        default:             return "depth";
+    }
+
+}
+
+// Compiler name and version the engine was built with
+static std::string compiler_info() {
+
+    std::stringstream ss;
+
+#if defined(__clang__)
+    ss << "clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__;
+#elif defined(__GNUC__)
+    ss << "g++ " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__;
+#elif defined(_MSC_VER)
+    ss << "MSVC " << _MSC_VER;
+#else
+    ss << "unknown";
+#endif
+
+    return ss.str();
+
+}
+
+// Build options detected from predefined macros, since the exact compiler flags are not available at runtime
+static std::string build_flags() {
+
+    std::string flags;
+
+#ifdef NDEBUG
+    flags += " NDEBUG";
+#endif
+#ifdef __OPTIMIZE__
+    flags += " OPTIMIZE";
+#endif
+#ifdef __SSE4_2__
+    flags += " SSE4.2";
+#endif
+#ifdef __POPCNT__
+    flags += " POPCNT";
+#endif
+#ifdef __AVX2__
+    flags += " AVX2";
+#endif
+#ifdef __BMI2__
+    flags += " BMI2";
+#endif
+#ifdef __AVX512F__
+    flags += " AVX512F";
+#endif
+#ifdef __ARM_NEON
+    flags += " NEON";
+#endif
+
+    return flags.empty() ? "none" : flags.substr(1);
+
+}
+
+// CPU model as reported by the operating system
+static std::string cpu_model() {
+
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 && line.find(':') != std::string::npos) {
+            return line.substr(line.find_first_not_of(" \t", line.find(':') + 1));
+        }
+    }
+
+    return "unknown";
+
+}
+
+// Escape a string for a JSON string literal; quotes, backslashes and all control characters are escaped
+static std::string json_escape(const std::string& string) {
+
+    std::string escaped;
+
+    for (const char c : string) {
+        switch (c) {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char Digits[] = "0123456789abcdef";
+                    escaped += "\\u00";
+                    escaped += Digits[c >> 4];
+                    escaped += Digits[c & 0xF];
+                } else {
+                    escaped += c;
+                }
+                break;
+        }
+    }
+
+    return escaped;
+
+}
+
+static void write_text_report(std::ostream& os, const BenchmarkSettings& settings, const std::vector<TrialResult>& trials, const PerfCounters* counters, const Duration elapsed) {
+
+    const TrialResult& last = trials.back();
+
+    uint64_t nodes = 0;
+
+    for (const TrialResult& trial : trials) {
+        nodes += trial_nodes(trial);
+    }
+
+    os << std::endl;
+    os << "========== BENCHMARK FINISHED ==========" << std::endl;
+    os << "Position" << std::setw(14) << "Nodes" << std::setw(12) << "Time (ms)" << std::setw(12) << "NPS" << std::endl;
+
+    for (unsigned i = 0; i < last.size(); i++) {
+        os << std::setw(8)  << (i + 1)
+           << std::setw(14) << last[i].nodes
+           << std::setw(12) << last[i].time
+           << std::setw(12) << nodes_per_second(last[i].nodes, last[i].time) << std::endl;
+    }
+
+    // Hardware events per node of every position
+    if (counters) {
+        os << std::endl << "Position";
+        for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+            os << std::setw(15) << PerfEventNames[event] + "/n";
+        }
+        os << std::setw(8) << "IPC" << std::endl;
+        for (unsigned i = 0; i <= last.size(); i++) {
+            const bool total = i == last.size();
+            const PositionResult result = total ? trial_total(last) : last[i];
+            os << std::setw(8) << (total ? "Total" : std::to_string(i + 1));
+            for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+                os << std::setw(15) << per_node(result, *counters, PerfEvent(event));
+            }
+            os << std::setw(8) << instructions_per_cycle(result, *counters) << std::endl;
+        }
+    }
+
+    // With multiple trials, show the throughput of each one
+    if (trials.size() > 1) {
+        os << std::endl << "Trial" << std::setw(17) << "Nodes" << std::setw(12) << "Time (ms)" << std::setw(12) << "NPS" << std::endl;
+        for (unsigned i = 0; i < trials.size(); i++) {
+            os << std::setw(5)  << (i + 1)
+               << std::setw(17) << trial_nodes(trials[i])
+               << std::setw(12) << trial_time(trials[i])
+               << std::setw(12) << nodes_per_second(trial_nodes(trials[i]), trial_time(trials[i])) << std::endl;
+        }
+    }
+
+    os << std::endl;
+    os << "Positions:                  " << std::setw(12) << last.size() << std::endl;
+    os << "Threads:                    " << std::setw(12) << settings.threads << std::endl;
+    os << "Hash (MB):                  " << std::setw(12) << settings.hashSize << std::endl;
+    os << "Time elapsed (ms):          " << std::setw(12) << elapsed << std::endl;
+    os << "Nodes searched (total):     " << std::setw(12) << trial_nodes(last) << std::endl;
+    os << "Nodes searched (per second):" << std::setw(12) << nodes_per_second(nodes, elapsed) << std::endl << std::endl;
+
+}
+
+// Hardware event counts as a JSON object; unsupported events are left out
+static std::string json_counters(const PositionResult& result, const PerfCounters& counters) {
+
+    std::stringstream ss;
+    bool first = true;
+
+    ss << "{ ";
+    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+        if (counters.is_supported(PerfEvent(event))) {
+            ss << (first ? "" : ", ") << "\"" << PerfEventNames[event] << "\": " << result.counters[event];
+            first = false;
+        }
+    }
+    ss << " }";
+
+    return ss.str();
+
+}
+
+#ifdef SEARCH_STATS
+// Search statistics as a JSON object
+static std::string json_search_stats(const SearchStats& stats) {
+
+    std::stringstream ss;
+
+    ss << "{ ";
+    for (unsigned stat = 0; stat < STAT_COUNT; stat++) {
+        ss << (stat ? ", " : "") << "\"" << SearchStatNames[stat] << "\": " << stats[stat];
+    }
+    ss << " }";
+
+    return ss.str();
+
+}
+#endif
+
+static void write_json_report(std::ostream& os, const BenchmarkSettings& settings, const std::vector<std::string>& fens, const std::vector<TrialResult>& trials, const PerfCounters* counters) {
+
+    os << "{" << std::endl;
+    os << "  \"engine\": \"Delocto " << VERSION << "\"," << std::endl;
+    os << "  \"compiler\": \"" << json_escape(compiler_info()) << "\"," << std::endl;
+    os << "  \"flags\": \"" << json_escape(build_flags()) << "\"," << std::endl;
+    os << "  \"cpu\": \"" << json_escape(cpu_model()) << "\"," << std::endl;
+    os << "  \"threads\": " << settings.threads << "," << std::endl;
+    os << "  \"hash\": " << settings.hashSize << "," << std::endl;
+    os << "  \"limit_type\": \"" << limit_type_name(settings.limitType) << "\"," << std::endl;
+    os << "  \"limit\": " << settings.limit << "," << std::endl;
+
+    // Summary of all trials, this is what benchcompare reads
+    os << "  \"trial_nps\": [";
+    for (unsigned i = 0; i < trials.size(); i++) {
+        os << (i ? ", " : "") << nodes_per_second(trial_nodes(trials[i]), trial_time(trials[i]));
+    }
+    os << "]," << std::endl;
+
+    os << "  \"trials\": [" << std::endl;
+
+    for (unsigned t = 0; t < trials.size(); t++) {
+
+        const TrialResult& trial = trials[t];
+
+        os << "    {" << std::endl;
+        os << "      \"nodes\": " << trial_nodes(trial) << "," << std::endl;
+        os << "      \"time_ms\": " << trial_time(trial) << "," << std::endl;
+        os << "      \"nps\": " << nodes_per_second(trial_nodes(trial), trial_time(trial)) << "," << std::endl;
+        if (counters) {
+            os << "      \"counters\": " << json_counters(trial_total(trial), *counters) << "," << std::endl;
+        }
+        os << "      \"positions\": [" << std::endl;
+
+        for (unsigned i = 0; i < trial.size(); i++) {
+            os << "        { \"fen\": \"" << json_escape(fens[i]) << "\""
+               << ", \"nodes\": " << trial[i].nodes
+               << ", \"time_ms\": " << trial[i].time
+               << ", \"nps\": " << nodes_per_second(trial[i].nodes, trial[i].time)
+               << ", \"tt_hit_rate\": " << hash_table_hit_rate(trial[i])
+               << ", \"seldepth\": " << trial[i].selectiveDepth
+               << (counters ? ", \"counters\": " + json_counters(trial[i], *counters) : "")
+#ifdef SEARCH_STATS
+               << ", \"search_stats\": " << json_search_stats(trial[i].stats)
+#endif
+               << " }"
+               << (i + 1 < trial.size() ? "," : "") << std::endl;
+        }
+
+        os << "      ]" << std::endl;
+        os << "    }" << (t + 1 < trials.size() ? "," : "") << std::endl;
+
+    }
+
+    os << "  ]" << std::endl;
+    os << "}" << std::endl;
+
+}
+
+static void write_csv_report(std::ostream& os, const BenchmarkSettings& settings, const std::vector<std::string>& fens, const std::vector<TrialResult>& trials, const PerfCounters* counters) {
+
+    // Metadata is written as comment lines so the rows stay easy to import
+    os << "# engine: Delocto " << VERSION << std::endl;
+    os << "# compiler: " << compiler_info() << std::endl;
+    os << "# flags: " << build_flags() << std::endl;
+    os << "# cpu: " << cpu_model() << std::endl;
+    os << "# threads: " << settings.threads << ", hash: " << settings.hashSize
+       << ", limit: " << limit_type_name(settings.limitType) << " " << settings.limit << std::endl;
+    os << "trial,position,nodes,time_ms,nps,tt_hit_rate,seldepth,";
+    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+        if (counters && counters->is_supported(PerfEvent(event))) {
+            os << PerfEventNames[event] << ",";
+        }
+    }
+    os << "fen" << std::endl;
+
+    for (unsigned t = 0; t < trials.size(); t++) {
+        for (unsigned i = 0; i < trials[t].size(); i++) {
+            const PositionResult& result = trials[t][i];
+            os << (t + 1) << "," << (i + 1) << ","
+               << result.nodes << "," << result.time << ","
+               << nodes_per_second(result.nodes, result.time) << ","
+               << hash_table_hit_rate(result) << ","
+               << result.selectiveDepth << ",";
+            for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+                if (counters && counters->is_supported(PerfEvent(event))) {
+                    os << result.counters[event] << ",";
+                }
+            }
+            os << fens[i] << std::endl;
+        }
+    }
+
+}
+
+// Runs a benchmark over a set of testing positions to retrieve a number of total visited
+// nodes. With the default settings this number should stay consistent and can be used
+// as a verification of search/evaluation integrity. Other settings allow comparing
+// the performance of different machines and configurations
+uint64_t benchmark(const BenchmarkSettings& settings) {
+
+    std::vector<std::string> fens = load_positions(settings.positions);
+
+    if (fens.empty()) {
+        return 0;
+    }
 
     Board board;
     SearchLimits limits;
-    limits.depth = 8;
 
-    uint64_t nodes = 0;
+    switch (settings.limitType) {
+        case BENCH_DEPTH:    limits.depth    = settings.limit; break;
+        case BENCH_NODES:    limits.nodes    = settings.limit; break;
+        case BENCH_MOVETIME: limits.moveTime = settings.limit; break;
+    }
+
+    const bool verbose = settings.format == FORMAT_TEXT;
+
+    std::vector<TrialResult> trials;
+
+    Threads.resize(settings.threads);
+    Threads.set_silent(!verbose);
+    TTable.set_size(settings.hashSize);
 
-    // Set thread count to 1 for consistency
-    Threads.resize(1);
-    Threads.reset();
+    // Hardware performance counters are attached to every search thread
+    std::vector<PerfCounters> counters(settings.counters ? Threads.get_thread_count() : 0);
+    bool countersAvailable = settings.counters;
+
+    for (unsigned i = 0; i < counters.size(); i++) {
+        countersAvailable &= counters[i].open(Threads.get_thread(i)->get_system_id());
+    }
+
+    // The counts of all threads are added up, so only the events every thread could open are counted
+    if (countersAvailable) {
+        for (unsigned i = 1; i < counters.size(); i++) {
+            counters.front().retain(counters[i]);
+        }
+        for (unsigned i = 1; i < counters.size(); i++) {
+            counters[i].retain(counters.front());
+        }
+        countersAvailable = counters.front().is_open();
+    }
+
+    if (settings.counters && !countersAvailable) {
+        UCI::send_string("Warning: hardware performance counters are not available");
+    }
 
     TimePoint start = Clock::now();
 
-    for (unsigned i = 0; i < 42; i++) {
+    for (unsigned t = 0; t < settings.trials; t++) {
+
+        TrialResult trial;
 
-        std::cout << "Position: " << (i + 1) << std::endl;
-        board.set_fen(BENCHMARK_FENS[i]);
-        TTable.clear(); // Clear Transposition Table between searches
-        UCI::go(board, limits);
+        // Every trial starts from the same state, so that all of them search the same tree
+        Threads.reset();
 
-        // Wait for search thread to finish
-        Threads.wait_until_finished();
-        nodes += Threads.get_nodes();
+        for (unsigned i = 0; i < fens.size(); i++) {
+
+            // Search output passes through the output queue, so it is written out before the header
+            if (verbose) {
+                IO::flush();
+                std::cout << "Position: " << (i + 1) << "/" << fens.size() << std::endl;
+            }
+
+            board.set_fen(fens[i]);
+            TTable.clear(); // Clear Transposition Table between searches
+
+            if (countersAvailable) {
+                for (PerfCounters& threadCounters : counters) {
+                    threadCounters.start();
+                }
+            }
+
+            TimePoint positionStart = Clock::now();
+            UCI::go(board, limits);
+
+            // Wait for search thread to finish
+            Threads.wait_until_finished();
+
+            PositionResult result = {
+                Threads.get_nodes(),
+                get_time_elapsed(positionStart),
+                Threads.get_hash_table_hits(),
+                Threads.get_hash_table_probes(),
+                Threads.get_thread(0)->get_selective_depth(),
+                {},
+                Threads.get_search_stats()
+            };
+
+            if (countersAvailable) {
+                for (PerfCounters& threadCounters : counters) {
+                    threadCounters.stop();
+                    const PerfCounts counts = threadCounters.read();
+                    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+                        result.counters[event] += counts[event];
+                    }
+                }
+            }
+
+            trial.push_back(result);
+
+        }
+
+        trials.push_back(trial);
 
     }
     
     Duration elapsed = get_time_elapsed(start);
 
-    std::cout << std::endl;
-    std::cout << "========== BENCHMARK FINISHED ==========" << std::endl;
-    std::cout << "Time elapsed (ms):          " << std::setw(12) << elapsed << std::endl;
-    std::cout << "Nodes searched (total):     " << std::setw(12) << nodes << std::endl;
-    std::cout << "Nodes searched (per second):" << std::setw(12) << 1000 * nodes / elapsed << std::endl << std::endl;
+    std::ofstream file;
+
+    if (!settings.output.empty()) {
+        file.open(settings.output);
+        if (!file.is_open()) {
+            UCI::send_string("Error: could not open output file " + settings.output);
+        }
+    }
+
+    std::ostream& os = file.is_open() ? file : std::cout;
+
+    IO::flush();
 
-    // Reset thread pool to original value
+    const PerfCounters* reportCounters = countersAvailable ? &counters.front() : nullptr;
+
+    switch (settings.format) {
+        case FORMAT_TEXT: write_text_report(os, settings, trials, reportCounters, elapsed); break;
+        case FORMAT_JSON: write_json_report(os, settings, fens, trials, reportCounters); break;
+        case FORMAT_CSV:  write_csv_report(os, settings, fens, trials, reportCounters); break;
+    }
+
+    // Reset thread pool and hash table to the original values
+    Threads.set_silent(false);
     Threads.resize(ThreadsOption.get_value());
+    TTable.set_size(HashOption.get_value());
 
-    return nodes;
+    return trial_nodes(trials.front());
+
+}
+
+// Reads the per-trial NPS values of a JSON benchmark report
+std::vector<double> read_benchmark_report(const std::string& filename) {
+
+    std::vector<double> values;
+
+    std::ifstream file(filename);
+    std::stringstream content;
+    content << file.rdbuf();
+
+    const std::string report = content.str();
+    const std::size_t key = report.find("\"trial_nps\"");
+
+    if (key == std::string::npos) {
+        return values;
+    }
+
+    const std::size_t begin = report.find('[', key);
+    const std::size_t end = report.find(']', begin);
+
+    if (begin == std::string::npos || end == std::string::npos) {
+        return values;
+    }
+
+    std::stringstream ss(report.substr(begin + 1, end - begin - 1));
+    std::string value;
+
+    try {
+        while (std::getline(ss, value, ',')) {
+            values.push_back(std::stod(value));
+        }
+    } catch (const std::exception&) {
+        values.clear();
+    }
+
+    return values;
+
+}
+
+// Two-sided 95% quantile of the Student t distribution
+static double t_quantile(const double df) {
+
+    static const double quantiles[30] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+         2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+         2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+
+    if (df < 1) {
+        return quantiles[0];
+    }
+
+    // Beyond the table the quantile approaches the normal distribution
+    return df <= 30 ? quantiles[unsigned(df) - 1] : 1.96 + 2.4 / df;
+
+}
+
+static double mean(const std::vector<double>& values) {
+
+    double sum = 0;
+
+    for (const double value : values) {
+        sum += value;
+    }
+
+    return sum / values.size();
+
+}
+
+static double variance(const std::vector<double>& values) {
+
+    if (values.size() < 2) {
+        return 0;
+    }
+
+    const double m = mean(values);
+    double sum = 0;
+
+    for (const double value : values) {
+        sum += (value - m) * (value - m);
+    }
+
+    return sum / (values.size() - 1);
+
+}
+
+// Compares the NPS of two JSON benchmark reports (created with bench ... format json trials N)
+// and reports the relative difference of the second to the first one with a 95% confidence
+// interval using Welch's t-test
+bool compare_benchmarks(const std::string& first, const std::string& second) {
+
+    const std::vector<double> a = read_benchmark_report(first);
+    const std::vector<double> b = read_benchmark_report(second);
+
+    if (a.empty() || b.empty()) {
+        UCI::send_string("Error: could not read trial results from " + (a.empty() ? first : second));
+        return false;
+    }
+
+    const double meanA = mean(a), meanB = mean(b);
+    const double varA = variance(a) / a.size(), varB = variance(b) / b.size();
+
+    // Formatted into a separate stream, so the state of std::cout is left untouched
+    std::stringstream out;
+
+    out << std::fixed << std::setprecision(0);
+    out << "Report" << std::setw(30) << "Trials" << std::setw(14) << "Mean NPS" << std::setw(14) << "Std. dev." << std::endl;
+    out << std::left << std::setw(30) << first.substr(0, 29) << std::right << std::setw(6) << a.size()
+        << std::setw(14) << meanA << std::setw(14) << std::sqrt(variance(a)) << std::endl;
+    out << std::left << std::setw(30) << second.substr(0, 29) << std::right << std::setw(6) << b.size()
+        << std::setw(14) << meanB << std::setw(14) << std::sqrt(variance(b)) << std::endl << std::endl;
+
+    const double difference = 100.0 * (meanB - meanA) / meanA;
+
+    out << std::showpos << std::setprecision(2);
+    out << "Difference: " << difference << "%";
+
+    // A confidence interval needs at least two trials on each side
+    if (a.size() < 2 || b.size() < 2) {
+        out << std::noshowpos << std::endl << "Run at least two trials per report for a confidence interval" << std::endl;
+        std::cout << out.str();
+        return true;
+    }
+
+    const double error = std::sqrt(varA + varB);
+    const double df = error > 0 ? std::pow(varA + varB, 2) / (varA * varA / (a.size() - 1) + varB * varB / (b.size() - 1)) : a.size() + b.size() - 2;
+    const double margin = 100.0 * t_quantile(df) * error / meanA;
+
+    out << " (95% CI: " << difference - margin << "% .. " << difference + margin << "%)" << std::endl;
+    out << std::noshowpos;
+
+    if (difference - margin > 0) {
+        out << "Result: significantly faster" << std::endl;
+    } else if (difference + margin < 0) {
+        out << "Result: significantly slower" << std::endl;
+    } else {
+        out << "Result: no significant difference" << std::endl;
+    }
+
+    std::cout << out.str();
+
+    return true;
 
-}
\ No newline at end of file
+}
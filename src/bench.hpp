@@ -23,6 +23,42 @@
 #ifndef BENCH_H
 #define BENCH_H
 
-extern uint64_t benchmark();
+#include <string>
+#include <sstream>
+#include <vector>
+
+#include "types.hpp"
+
+// Which search limit the benchmark applies to every position
+enum BenchmarkLimitType {
+    BENCH_DEPTH, BENCH_NODES, BENCH_MOVETIME
+};
+
+// Format of the benchmark report
+enum BenchmarkFormat {
+    FORMAT_TEXT, FORMAT_JSON, FORMAT_CSV
+};
+
+// Settings of a benchmark run. The defaults reproduce the reference benchmark
+// whose node count is used as a signature of search/evaluation integrity
+struct BenchmarkSettings {
+
+    uint64_t limit = 8;
+    unsigned threads = 1;
+    unsigned hashSize = 64;
+    std::string positions = "default";
+    BenchmarkLimitType limitType = BENCH_DEPTH;
+
+    BenchmarkFormat format = FORMAT_TEXT;
+    unsigned trials = 1;
+    std::string output; // Report is written to standard output if empty
+    bool counters = false; // Measure hardware performance counters (Linux only)
+
+};
+
+extern bool parse_benchmark_settings(std::stringstream& ss, BenchmarkSettings& settings);
+extern uint64_t benchmark(const BenchmarkSettings& settings = BenchmarkSettings());
+extern std::vector<double> read_benchmark_report(const std::string& filename);
+extern bool compare_benchmarks(const std::string& first, const std::string& second);
 
 #endif
\ No newline at end of file
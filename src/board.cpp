@@ -38,9 +38,11 @@ static const char PieceToChar[COLOR_COUNT][PIECETYPE_COUNT] = {
 // Remove all pieces from the board and reset the game state
 void Board::clear() {
 
-    // Clear the state and move lists
+    // Clear the state, move, accumulator and attack map lists
     states.clear();
     moves.clear();
+    accumulators.clear();
+    attackMaps.clear();
 
     // Clear all bitboards
     bbColors[WHITE] = 0;
@@ -81,12 +83,11 @@ void Board::clear() {
 
 }
 
-// Calculate position, pawn and material hash key
+// Calculate position and pawn hash key
 void Board::calc_keys() {
 
     state.hashKey = 0;
     state.pawnKey = 0;
-    state.materialKey = 0;
 
     Bitboard occupied = bbColors[BOTH];
 
@@ -106,13 +107,6 @@ void Board::calc_keys() {
 
     }
 
-    // Generate the material hash key
-    for (Color c = WHITE; c < COLOR_COUNT; ++c) {
-        for (Piecetype pt = PAWN; pt < PIECETYPE_COUNT; ++pt) {
-            hash_material(c, pt);
-        }
-    }
-
     // Update the position hash key with en-passant square, castling rights and the color to move
     hash_enPassant();
     hash_castling();
@@ -126,7 +120,9 @@ void Board::update_check_info() {
     state.kingBlockers[WHITE] = get_slider_blockers(bbColors[BLACK], lsb_index(pieces(WHITE, KING)));
     state.kingBlockers[BLACK] = get_slider_blockers(bbColors[WHITE], lsb_index(pieces(BLACK, KING)));
 
-    state.checkers = sq_attackers(!stm, lsb_index(pieces(stm, KING)), bbColors[BOTH]);
+    // With an attack map, the checkers only need to be searched if the king is attacked at all
+    const Square ownKsq = lsb_index(pieces(stm, KING));
+    state.checkers = (!has_attack_map() || sq_attacked(ownKsq, !stm)) ? sq_attackers(!stm, ownKsq, bbColors[BOTH]) : 0;
 
     Square ksq = king_square(!stm);
 
@@ -311,10 +307,73 @@ void Board::set_fen(std::string fen) {
         ply = (std::stoi(cut.substr(space)) - 1) * 2;
     }
 
+    refresh_attack_map();
+
     // Update checkers and king blockers and calculate the hash keys
     update_check_info();
     calc_keys();
 
+    refresh_accumulator();
+
+}
+
+// Recompute the attack map from scratch if attack maps are enabled, otherwise stop updating it
+void Board::refresh_attack_map() {
+
+    if (AttackMaps::is_enabled()) {
+        attackMaps.resize(1);
+        AttackMaps::refresh(*this, attackMaps.back());
+    } else {
+        attackMaps.clear();
+    }
+
+}
+
+// Recompute the NNUE accumulator from scratch if the network is enabled, otherwise stop
+// updating it
+void Board::refresh_accumulator() {
+
+    if (NNUE::is_enabled()) {
+        accumulators.resize(1);
+        NNUE::refresh(*this, accumulators.back());
+    } else {
+        accumulators.clear();
+    }
+
+}
+
+// Push the NNUE accumulator for the position after the given move, updated with the pieces
+// that were added and removed by the move. Must be called before the turn is switched
+void Board::update_accumulator(const Move move, const Piecetype pieceType, const Piecetype captured) {
+
+    const Square fromSq     = from_sq(move);
+    const Square toSq       = to_sq(move);
+    const MoveType moveType = move_type(move);
+
+    NNUE::FeatureChange added[2];
+    NNUE::FeatureChange removed[2];
+    unsigned addedCount = 0;
+    unsigned removedCount = 0;
+
+    removed[removedCount++] = { stm, pieceType, fromSq };
+    added[addedCount++]     = { stm, pieceTypes[toSq], toSq }; // Takes care of promotions
+
+    if (captured != PIECE_NONE) {
+        removed[removedCount++] = { !stm, captured, toSq };
+    }
+
+    if (moveType == CASTLING) {
+        const Square rookToSq   = toSq + ((toSq == SQUARE_G1 || toSq == SQUARE_G8) ?  1 : -1);
+        const Square rookFromSq = toSq + ((toSq == SQUARE_G1 || toSq == SQUARE_G8) ? -1 :  2);
+        removed[removedCount++] = { stm, ROOK, rookFromSq };
+        added[addedCount++]     = { stm, ROOK, rookToSq };
+    } else if (moveType == ENPASSANT) {
+        removed[removedCount++] = { !stm, PAWN, toSq + direction(stm, DOWN) };
+    }
+
+    accumulators.emplace_back();
+    NNUE::update(accumulators[accumulators.size() - 2], accumulators.back(), added, addedCount, removed, removedCount);
+
 }
 
 // Get a FEN string from the current piece setup on the board
@@ -386,6 +445,138 @@ std::string Board::get_fen() const {
 
 }
 
+// Set up the board from a packed position without going through a FEN string.
+// Returns false and leaves the board unchanged if the position is malformed or illegal
+bool Board::from_packed(const PackedPosition& position) {
+
+    if (popcount(position.occupied) > 32) {
+        return false;
+    }
+
+    std::array<Bitboard, COLOR_COUNT> colors = {};
+    std::array<Bitboard, PIECETYPE_COUNT> types = {};
+
+    Bitboard occupied = position.occupied;
+    unsigned index = 0;
+    while (occupied) {
+        const Square sq = pop_lsb(occupied);
+        const uint8_t code = (position.pieces[index / 2] >> (4 * (index % 2))) & 0xF;
+        if ((code & 0x7) > KING) {
+            return false;
+        }
+        colors[code >> 3] |= SQUARES[sq];
+        types[code & 0x7] |= SQUARES[sq];
+        index++;
+    }
+
+    if (   popcount(colors[WHITE] & types[KING]) != 1
+        || popcount(colors[BLACK] & types[KING]) != 1
+        || (types[PAWN] & (BB_RANK_1 | BB_RANK_8)))
+    {
+        return false;
+    }
+
+    const Color side = Color(position.flags & 1);
+
+    // Castling rights need the king and the rook on their original squares
+    for (Color color = WHITE; color <= BLACK; ++color) {
+        for (const CastleType type : { CASTLE_SHORT, CASTLE_LONG }) {
+            if (   ((position.flags >> 1) & CASTLE_RIGHTS[color][type])
+                && (   !(colors[color] & types[KING] & SQUARES[KING_INITIAL_SQUARE[color]])
+                    || !(colors[color] & types[ROOK] & SQUARES[CASTLE_ROOK_ORIGIN_SQUARE[color][type]])))
+            {
+                return false;
+            }
+        }
+    }
+
+    // The en-passant square is empty and the pawn which just made a double push stands in front of it
+    if (position.enPassant < SQUARE_NONE) {
+        const Square epSq   = Square(position.enPassant);
+        const Square pawnSq = Square(side == WHITE ? epSq - 8 : epSq + 8);
+        if (   relative_rank(side, epSq) != RANK_6
+            || (position.occupied & SQUARES[epSq])
+            || !(colors[!side] & types[PAWN] & SQUARES[pawnSq]))
+        {
+            return false;
+        }
+    }
+
+    // The king of the side which is not to move can not be in check
+    const Square ksq = lsb_index(colors[!side] & types[KING]);
+    if (  ((PawnAttacks[!side][ksq]                         & types[PAWN])
+         | (piece_attacks<KNIGHT>(ksq)                      & types[KNIGHT])
+         | (piece_attacks<BISHOP>(ksq, position.occupied)   & (types[BISHOP] | types[QUEEN]))
+         | (piece_attacks<ROOK>(ksq, position.occupied)     & (types[ROOK]   | types[QUEEN]))
+         | (piece_attacks<KING>(ksq)                        & types[KING])) & colors[side])
+    {
+        return false;
+    }
+
+    clear();
+
+    occupied = position.occupied;
+    index = 0;
+    while (occupied) {
+        const Square sq = pop_lsb(occupied);
+        const uint8_t code = (position.pieces[index / 2] >> (4 * (index % 2))) & 0xF;
+        add_piece(Color(code >> 3), Piecetype(code & 0x7), sq);
+        index++;
+    }
+
+    bbColors[BOTH] = position.occupied;
+
+    stm = side;
+
+    for (Color color = WHITE; color <= BLACK; ++color) {
+        for (const CastleType type : { CASTLE_SHORT, CASTLE_LONG }) {
+            if ((position.flags >> 1) & CASTLE_RIGHTS[color][type]) {
+                add_castle_right(color, type);
+            }
+        }
+    }
+
+    state.enPassant       = position.enPassant < SQUARE_NONE ? Square(position.enPassant) : SQUARE_NONE;
+    state.fiftyMovesCount = position.fiftyMovesCount;
+    ply = (std::max(position.fullMoves, uint16_t(1)) - 1) * 2;
+
+    refresh_attack_map();
+
+    // Update checkers and king blockers and calculate the hash keys
+    update_check_info();
+    calc_keys();
+
+    refresh_accumulator();
+
+    return true;
+
+}
+
+// Pack the position into a fixed size record. The game result and the score are left empty
+PackedPosition Board::to_packed() const {
+
+    PackedPosition position = {};
+
+    position.occupied = bbColors[BOTH];
+
+    Bitboard occupied = position.occupied;
+    unsigned index = 0;
+    while (occupied) {
+        const Square sq = pop_lsb(occupied);
+        position.pieces[index / 2] |= ((owner(sq) << 3) | pieceTypes[sq]) << (4 * (index % 2));
+        index++;
+    }
+
+    position.flags           = stm | (state.castleRights << 1);
+    position.enPassant       = state.enPassant;
+    position.fiftyMovesCount = std::min(state.fiftyMovesCount, 255u);
+    position.fullMoves       = ply / 2 + 1;
+    position.score           = VALUE_NONE;
+
+    return position;
+
+}
+
 // Convert the current position to a string for debuging purposals
 std::string Board::to_string() const {
 
@@ -418,8 +609,6 @@ std::string Board::to_string() const {
 // Adds a piece to the board given a square and a color
 void Board::add_piece(const Color color, const Piecetype pt, const Square sq) {
 
-    hash_material(color, pt);
-
     // Add the piece to the corresponding bitboards and increase the piece counter
     bbColors[color] |= SQUARES[sq];
     bbPieces[pt]    |= SQUARES[sq];
@@ -431,7 +620,6 @@ void Board::add_piece(const Color color, const Piecetype pt, const Square sq) {
     state.pst[color]      += PieceSquareTable[color][pt][sq];
 
     // Update the hash keys
-    hash_material(color, pt);
     hash_piece(color, pt, sq);
     if (pt == PAWN) {
         hash_pawn(color, sq);
@@ -445,9 +633,6 @@ void Board::remove_piece(const Square sq) {
     const Color color  = owner(sq);
     const Piecetype pt = pieceTypes[sq];
 
-    // Update the material hash key
-    hash_material(color, pt);
-
     // Remove the piece from the bitboards and update the piece counts
     bbColors[color] ^= SQUARES[sq];
     bbPieces[pt]    ^= SQUARES[sq];
@@ -459,7 +644,6 @@ void Board::remove_piece(const Square sq) {
     state.pst[color]      -= PieceSquareTable[color][pt][sq];
 
     // Update the hash keys and also the pawn hash key if the removed piece was a pawn
-    hash_material(color, pt);
     hash_piece(color, pt, sq);
     if (pt == PAWN) {
         hash_pawn(color, sq);
@@ -528,6 +712,9 @@ void Board::do_move(const Move move) {
     const Piecetype pieceType = pieceTypes[fromSq];
     const Piecetype captured  = pieceTypes[toSq];
 
+    // Squares on which a piece is added or removed by the move
+    Bitboard changed = SQUARES[fromSq] | SQUARES[toSq];
+
     // Add the current game state to the list of previous states
     states.push_back(state);
     moves.push_back(move);
@@ -584,6 +771,7 @@ void Board::do_move(const Move move) {
 
                 // If we castle, we need to move the rook as well
                 move_piece(rookFromSq, rookToSq);
+                changed |= SQUARES[rookFromSq] | SQUARES[rookToSq];
             }
             break;
 
@@ -595,6 +783,7 @@ void Board::do_move(const Move move) {
 
                 // Remove the pawn which has been captured en-passant
                 remove_piece(capSq);
+                changed |= SQUARES[capSq];
                 state.fiftyMovesCount = 0;
             }
             break;
@@ -614,6 +803,11 @@ void Board::do_move(const Move move) {
 
     }
 
+    // Update the NNUE accumulator with the changed pieces
+    if (has_accumulator()) {
+        update_accumulator(move, pieceType, captured);
+    }
+
     // Switch turn and update position hash key for turn
     hash_turn();
     stm = !stm;
@@ -622,6 +816,12 @@ void Board::do_move(const Move move) {
     // Update the combined colors bitboard
     bbColors[BOTH] = bbColors[WHITE] | bbColors[BLACK];
 
+    // Update the attack map with the changed squares
+    if (has_attack_map()) {
+        attackMaps.push_back(attackMaps.back());
+        AttackMaps::update(*this, attackMaps.back(), changed);
+    }
+
     // Update the king blockers and checkers
     update_check_info();
 
@@ -697,6 +897,21 @@ void Board::undo_move() {
     state = states.back();
     states.pop_back();
 
+    // Revert to the previous accumulator. If the accumulator was started at this position,
+    // there is none, so it has to be recomputed
+    if (accumulators.size() > 1) {
+        accumulators.pop_back();
+    } else if (has_accumulator()) {
+        NNUE::refresh(*this, accumulators.back());
+    }
+
+    // Revert to the previous attack map the same way
+    if (attackMaps.size() > 1) {
+        attackMaps.pop_back();
+    } else if (has_attack_map()) {
+        AttackMaps::refresh(*this, attackMaps.back());
+    }
+
 }
 
 // Do a null move on the board
@@ -738,6 +953,13 @@ bool Board::check_draw() {
 
 }
 
+// Checks that the side which is not to move can not be captured, so the position can be searched
+bool Board::is_opponent_safe() const {
+
+    return !sq_attacked(king_square(!stm), stm);
+
+}
+
 // Checks wether a given move on the current board is pseudo-legal
 // A move is invalid if it violates the rules of chess, however, this
 // method does not check if the move is actually legal, meaning it does
@@ -29,6 +29,8 @@
 #include "hashkeys.hpp"
 #include "movegen.hpp"
 #include "bitboards.hpp"
+#include "nnue.hpp"
+#include "attackmap.hpp"
 
 // FEN string of the inital position in chess
 static const std::string INITIAL_POSITION_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
@@ -53,10 +55,26 @@ struct StateInfo {
     // Hash keys
     uint64_t hashKey = 0;
     uint64_t pawnKey = 0;
-    uint64_t materialKey = 0;
 
 };
 
+// Fixed size encoding of a position for datasets and bulk processing, see Board::to_packed().
+// The game result and the score are not part of the position, they are filled in by datasets
+struct PackedPosition {
+
+    Bitboard occupied; // All occupied squares
+    uint8_t pieces[16]; // A 4-bit code (color << 3 | piece type) per occupied square in square order
+    uint8_t flags; // Side to move (bit 0) and castling rights (bits 1 - 4)
+    uint8_t enPassant; // En passant square, SQUARE_NONE if there is none
+    uint8_t fiftyMovesCount;
+    uint8_t result; // Dataset::GameResult
+    uint16_t fullMoves;
+    int16_t score; // Score in centipawns from white's point of view, VALUE_NONE if unknown
+
+};
+
+static_assert(sizeof(PackedPosition) == 32, "Packed positions should be tightly packed");
+
 static const int MvvLvaVictim[5]   = { 100, 200, 300, 400, 500 };
 static const int MvvLvaAttacker[6] = { 1, 2, 3, 4, 5, 0 };
 
@@ -95,7 +113,6 @@ class Board {
         inline Square king_square(const Color color) const { return lsb_index(bbPieces[KING] & bbColors[color]); };
 
         inline uint64_t hashkey() const { return state.hashKey; }
-        inline uint64_t materialkey() const { return state.materialKey; }
         inline uint64_t pawnkey() const { return state.pawnKey; }
 
         inline unsigned plies() const { return ply; }
@@ -108,8 +125,20 @@ class Board {
         inline unsigned piece_count(const Color color, const Piecetype pt) const { return pieceCounts[color][pt]; }
         inline unsigned piece_count(const Piecetype pt) const { return pieceCounts[WHITE][pt] + pieceCounts[BLACK][pt]; }
 
+        // The NNUE accumulator is only kept up to date while the network is enabled
+        inline bool has_accumulator() const { return !accumulators.empty(); }
+        inline const NNUE::Accumulator& accumulator() const { return accumulators.back(); }
+        void refresh_accumulator();
+
+        // The attack map is only kept up to date while attack maps are enabled
+        inline bool has_attack_map() const { return !attackMaps.empty(); }
+        inline const AttackMaps::AttackMap& attack_map() const { return attackMaps.back(); }
+        void refresh_attack_map();
+
         void set_fen(std::string fen);
         std::string get_fen() const;
+        bool from_packed(const PackedPosition& position);
+        PackedPosition to_packed() const;
         std::string to_string() const;
         void print() const { std::cout << to_string(); }
 
@@ -120,6 +149,7 @@ class Board {
 
         bool check_draw();
         bool is_material_draw() const;
+        bool is_opponent_safe() const;
 
         bool is_valid(const Move move) const;
         bool is_legal(const Move move) const;
@@ -129,6 +159,7 @@ class Board {
 
         int mvvlva(const Move move) const;
         int see(const Move move) const;
+        bool see_ge(const Move move, const Value threshold) const;
 
         inline Bitboard minors_and_majors(const Color color) const;
         inline Bitboard minors() const;
@@ -159,6 +190,12 @@ class Board {
         // List of previous board states
         std::vector<StateInfo> states;
 
+        // NNUE accumulators of the current and all previous positions
+        std::vector<NNUE::Accumulator> accumulators;
+
+        // Attack maps of the current and all previous positions
+        std::vector<AttackMaps::AttackMap> attackMaps;
+
         // Bitboards for each piece type and each color
         std::array<Bitboard, COLOR_COUNT+1> bbColors;
         std::array<Bitboard, PIECETYPE_COUNT> bbPieces;
@@ -184,7 +221,6 @@ class Board {
         inline void hash_castling();
         inline void hash_turn();
         inline void hash_enPassant();
-        inline void hash_material(const Color color, const Piecetype pt);
 
         void calc_keys();
 
@@ -192,6 +228,7 @@ class Board {
         void remove_piece(const Square sq);
         void move_piece(const Square fromSq, const Square toSq);
         void add_castle_right(Color color, CastleType type);
+        void update_accumulator(const Move move, const Piecetype pieceType, const Piecetype captured);
 
         inline Bitboard sq_attackers(const Color color, const Square sq, const Bitboard occupied) const;
         inline Bitboard slider_attackers(const Square sq, const Bitboard occupied) const;
@@ -323,13 +360,6 @@ inline void Board::hash_enPassant() {
 
 }
 
-// Hash material key in/out zobrist key
-inline void Board::hash_material(const Color color, const Piecetype pt) {
-
-    state.materialKey ^= MaterialHashKeys[color][pt][pieceCounts[color][pt]];
-
-}
-
 // Get a bitboard of all attackers of a color to a square
 inline Bitboard Board::sq_attackers(const Color color, const Square sq, const Bitboard occupied) const {
 
@@ -365,6 +395,10 @@ inline Bitboard Board::slider_attackers_discovered(const Color color, const Squa
 // Check if a square is attacked by a given color
 inline bool Board::sq_attacked(const Square sq, const Color color) const {
 
+    if (has_attack_map()) {
+        return attack_map().colorAttacks[color] & SQUARES[sq];
+    }
+
     return sq_attackers(color, sq, bbColors[BOTH]);
 
 }
@@ -0,0 +1,292 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+
+#include "datagen.hpp"
+#include "dataset.hpp"
+#include "io.hpp"
+#include "movegen.hpp"
+#include "thread.hpp"
+#include "timeman.hpp"
+#include "uci.hpp"
+
+// Adjudication of self-play games
+static constexpr int OpeningMaxScore   = 400; // Openings with a larger score are played again
+static constexpr int ResignScore       = 1500;
+static constexpr unsigned ResignPlies  = 6; // Consecutive plies with a score beyond ResignScore
+static constexpr int DrawScore         = 10;
+static constexpr unsigned DrawPlies    = 10; // Consecutive plies with a score within DrawScore...
+static constexpr unsigned DrawMinPly   = 80; // ...after this many plies
+static constexpr unsigned MaxGamePlies = 400;
+
+// Positions written at once. A crash loses at most this many positions per thread
+static constexpr unsigned FlushSize = 1024;
+
+// Parse the arguments of the datagen command: output file, positions, nodes per move, threads and random plies
+bool parse_datagen_settings(std::stringstream& ss, DatagenSettings& settings) {
+
+    std::vector<std::string> arguments;
+    std::string word;
+
+    while (ss >> word) {
+        arguments.push_back(word);
+    }
+
+    if (arguments.empty()) {
+        UCI::send_string("Error: no output file given");
+        return false;
+    }
+
+    settings.output = arguments[0];
+
+    try {
+        if (arguments.size() > 1) {
+            settings.positions = std::max(std::stoll(arguments[1]), 1ll);
+        }
+        if (arguments.size() > 2) {
+            settings.nodes = std::max(std::stoll(arguments[2]), 1ll);
+        }
+        if (arguments.size() > 3) {
+            settings.threads = std::clamp(std::stoi(arguments[3]), ThreadsOption.get_min(), ThreadsOption.get_max());
+        }
+        if (arguments.size() > 4) {
+            settings.randomPlies = std::max(std::stoi(arguments[4]), 0);
+        }
+    } catch (const std::exception&) {
+        UCI::send_string("Error: invalid numeric datagen argument");
+        return false;
+    }
+
+    return true;
+
+}
+
+// Shared state of all threads generating data
+struct DatagenState {
+
+    const DatagenSettings& settings;
+    Dataset::Writer writer;
+    std::mutex mutex;
+    std::atomic<uint64_t> positions{0};
+    std::atomic<uint64_t> games{0};
+    TimePoint start;
+
+    explicit DatagenState(const DatagenSettings& s) : settings(s) {}
+
+};
+
+// Play random moves from the initial position. Returns false if the game ended on the way
+static bool play_random_opening(Board& board, const unsigned plies, std::mt19937_64& rng) {
+
+    board.set_fen(INITIAL_POSITION_FEN);
+
+    for (unsigned ply = 0; ply < plies; ply++) {
+        const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+        if (moves.size() == 0) {
+            return false;
+        }
+        board.do_move(moves[rng() % moves.size()]);
+    }
+
+    return generate_moves<ALL, LEGAL>(board, board.turn()).size() > 0;
+
+}
+
+// Play a self-play game and add its quiet positions to the list. Returns false
+// if the opening was discarded or the generation was stopped
+static bool play_game(Thread& thread, const DatagenSettings& settings, std::mt19937_64& rng, std::vector<PackedPosition>& positions) {
+
+    Board board;
+
+    if (!play_random_opening(board, settings.randomPlies, rng)) {
+        return false;
+    }
+
+    SearchLimits limits;
+    limits.nodes = settings.nodes;
+
+    const size_t first = positions.size();
+    Dataset::GameResult result = Dataset::RESULT_DRAW;
+    unsigned resignCount = 0, drawCount = 0;
+
+    for (unsigned ply = 0; ; ply++) {
+
+        const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+
+        // Checkmate or stalemate
+        if (moves.size() == 0) {
+            if (board.checkers()) {
+                result = board.turn() == WHITE ? Dataset::RESULT_BLACK_WIN : Dataset::RESULT_WHITE_WIN;
+            }
+            break;
+        }
+
+        if (board.check_draw() || ply >= MaxGamePlies) {
+            break;
+        }
+
+        const SearchResult search = thread.search_alone(board, limits);
+
+        if (Threads.has_stopped() || search.bestMove == MOVE_NONE) {
+            positions.resize(first);
+            return false;
+        }
+
+        if (ply == 0 && std::abs(search.value) > OpeningMaxScore) {
+            return false;
+        }
+
+        const int whiteValue = board.turn() == WHITE ? search.value : -search.value;
+
+        // Adjudicate decided and dead drawn games
+        resignCount = std::abs(search.value) >= ResignScore ? resignCount + 1 : 0;
+        drawCount   = std::abs(search.value) <= DrawScore ? drawCount + 1 : 0;
+
+        if (resignCount >= ResignPlies || std::abs(search.value) >= VALUE_MATE_MAX) {
+            result = whiteValue > 0 ? Dataset::RESULT_WHITE_WIN : Dataset::RESULT_BLACK_WIN;
+            break;
+        }
+
+        if (ply >= DrawMinPly && drawCount >= DrawPlies) {
+            break;
+        }
+
+        // Keep quiet positions only, their scores are close to the static evaluation
+        if (!board.checkers() && !board.is_capture(search.bestMove) && !is_promotion(search.bestMove)) {
+            positions.push_back(Dataset::pack(board, Dataset::RESULT_DRAW, whiteValue));
+        }
+
+        board.do_move(search.bestMove);
+
+    }
+
+    for (size_t i = first; i < positions.size(); i++) {
+        positions[i].result = result;
+    }
+
+    return true;
+
+}
+
+// Write the finished games of a thread to the dataset file
+static void flush_positions(DatagenState& state, std::vector<PackedPosition>& positions) {
+
+    std::lock_guard<std::mutex> lock(state.mutex);
+
+    for (const PackedPosition& position : positions) {
+        state.writer.write(position);
+    }
+
+    state.writer.flush();
+    positions.clear();
+
+}
+
+// Play games on one thread until the dataset has the requested size or the pool is stopped
+static void generate_data_thread(Thread& thread, DatagenState& state) {
+
+    std::mt19937_64 rng(std::chrono::steady_clock::now().time_since_epoch().count() + thread.get_index() * 0x9E3779B97F4A7C15ull);
+    std::vector<PackedPosition> positions;
+    TimePoint lastReport = Clock::now();
+
+    while (!Threads.has_stopped() && state.positions < state.settings.positions) {
+
+        const size_t before = positions.size();
+
+        if (!play_game(thread, state.settings, rng, positions)) {
+            continue;
+        }
+
+        state.positions += positions.size() - before;
+        state.games++;
+
+        if (positions.size() >= FlushSize) {
+            flush_positions(state, positions);
+        }
+
+        if (thread.get_index() == 0 && get_time_elapsed(lastReport) >= 10000) {
+            lastReport = Clock::now();
+            UCI::send_string("datagen games " + std::to_string(state.games) + " positions " + std::to_string(state.positions));
+        }
+
+    }
+
+    flush_positions(state, positions);
+
+}
+
+// Generate a dataset with self-play games on all threads. Positions already in the output
+// file are kept and count towards the requested number, so an interrupted run can be resumed
+uint64_t generate_data(const DatagenSettings& settings) {
+
+    DatagenState state(settings);
+
+    {
+        Dataset::Reader existing;
+        if (existing.open(settings.output)) {
+            state.positions = existing.size();
+        }
+    }
+
+    if (!state.writer.open(settings.output, true)) {
+        UCI::send_string("Error: could not open dataset " + settings.output);
+        return 0;
+    }
+
+    const uint64_t resumed = state.positions;
+    if (resumed) {
+        UCI::send_string("Resuming with " + std::to_string(resumed) + " positions");
+    }
+
+    Threads.resize(settings.threads);
+    Threads.reset();
+    TTable.clear();
+
+    state.start = Clock::now();
+
+    Threads.start_jobs([&state](Thread& thread) { generate_data_thread(thread, state); });
+    Threads.wait_until_finished();
+    Threads.stop_searching();
+
+    const double hours = std::max(get_time_elapsed(state.start), Duration(1)) / 3600000.0;
+    const uint64_t generated = state.positions - resumed;
+
+    // Write out the queued progress lines before the summary
+    IO::flush();
+
+    std::cout << "Games played:                " << std::setw(12) << state.games << std::endl;
+    std::cout << "Positions written:           " << std::setw(12) << generated << std::endl;
+    std::cout << "Positions per hour:          " << std::setw(12) << uint64_t(generated / hours) << std::endl;
+    std::cout << "Positions per hour/thread:   " << std::setw(12) << uint64_t(generated / hours / settings.threads) << std::endl;
+
+    Threads.resize(ThreadsOption.get_value());
+
+    return generated;
+
+}
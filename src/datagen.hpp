@@ -0,0 +1,47 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <sstream>
+#include <string>
+
+#include "types.hpp"
+
+// Settings for generating training data with self-play games. Every thread of the pool
+// plays its own games with fixed node searches, starting from random openings
+struct DatagenSettings {
+
+    std::string output;
+    uint64_t positions = 100000; // Target size of the dataset file, including positions from earlier runs
+    uint64_t nodes = 5000; // Nodes per move
+    unsigned threads = 1;
+    unsigned randomPlies = 8; // Random moves played from the initial position
+
+};
+
+extern bool parse_datagen_settings(std::stringstream& ss, DatagenSettings& settings);
+extern uint64_t generate_data(const DatagenSettings& settings);
+
+#endif
@@ -0,0 +1,427 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#include "dataset.hpp"
+#include "thread.hpp"
+#include "uci.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Dataset {
+
+    static constexpr char     FileMagic[4] = { 'D', 'L', 'D', 'S' };
+    static constexpr uint32_t FileVersion  = 1;
+
+    static const std::string PieceChars = "PNBRQKpnbrqk";
+
+    // Pack the position together with the result of the game it was taken from
+    PackedPosition pack(const Board& board, const GameResult result, const int score) {
+
+        PackedPosition position = board.to_packed();
+        position.result = result;
+        position.score  = score;
+
+        return position;
+
+    }
+
+    // Check that the piece placement of a FEN string describes a board with one king per color
+    static bool is_valid_placement(const std::string& placement) {
+
+        unsigned ranks = 1, files = 0, whiteKings = 0, blackKings = 0;
+
+        for (const char c : placement) {
+            if (c == '/') {
+                if (files != 8) {
+                    return false;
+                }
+                ranks++;
+                files = 0;
+            } else if (c >= '1' && c <= '8') {
+                files += c - '0';
+            } else if (PieceChars.find(c) != std::string::npos) {
+                whiteKings += c == 'K';
+                blackKings += c == 'k';
+                files++;
+            } else {
+                return false;
+            }
+            if (files > 8) {
+                return false;
+            }
+        }
+
+        return ranks == 8 && files == 8 && whiteKings == 1 && blackKings == 1;
+
+    }
+
+    // Read the FEN string at the start of an EPD or labelled position line. The halfmove and fullmove
+    // counters are optional; if they are missing, the stream is left at the first operation
+    bool parse_position(std::istringstream& ss, std::string& fen) {
+
+        std::string placement, turn, castling, enPassant;
+
+        if (!(ss >> placement >> turn >> castling >> enPassant)) {
+            return false;
+        }
+
+        if (   !is_valid_placement(placement)
+            || (turn != "w" && turn != "b")
+            || castling.find_first_not_of("KQkq-") != std::string::npos
+            || (enPassant != "-" && (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || (enPassant[1] != '3' && enPassant[1] != '6'))))
+        {
+            return false;
+        }
+
+        fen = placement + ' ' + turn + ' ' + castling + ' ' + enPassant;
+
+        // Optional halfmove and fullmove counters
+        const std::streampos operations = ss.tellg();
+        std::string halfMoves, fullMoves;
+
+        if (   (ss >> halfMoves >> fullMoves)
+            && halfMoves.find_first_not_of("0123456789") == std::string::npos
+            && std::isdigit(fullMoves[0]))
+        {
+            fen += ' ' + halfMoves + ' ' + fullMoves;
+        } else {
+            ss.clear();
+            ss.seekg(operations);
+        }
+
+        return true;
+
+    }
+
+    // Game result of a label "1-0", "0-1" or "1/2-1/2", or of the numbers 1.0, 0.0 and 0.5
+    static bool parse_result(const std::string& label, GameResult& result) {
+
+        if (label == "1-0" || label == "1.0") {
+            result = RESULT_WHITE_WIN;
+        } else if (label == "0-1" || label == "0.0") {
+            result = RESULT_BLACK_WIN;
+        } else if (label == "1/2-1/2" || label == "0.5") {
+            result = RESULT_DRAW;
+        } else {
+            return false;
+        }
+
+        return true;
+
+    }
+
+    // Parse a line of a labelled position file. The line starts with a FEN string, the halfmove and
+    // fullmove counters are optional. The game result is taken from the c9 operation (e.g. c9 "1-0";)
+    // or from a last word in brackets (e.g. [0.5]), other operations are ignored
+    bool parse_labelled_line(const std::string& line, std::string& fen, GameResult& result) {
+
+        std::istringstream ss(line);
+
+        if (!parse_position(ss, fen)) {
+            return false;
+        }
+
+        std::string word;
+        std::vector<std::string> words;
+        while (ss >> word) {
+            words.push_back(word);
+        }
+
+        for (unsigned i = 0; i + 1 < words.size(); i++) {
+
+            if (words[i] == "c9") {
+                std::string label = words[i + 1];
+                label.erase(std::remove_if(label.begin(), label.end(), [](const char c) { return c == '"' || c == ';'; }), label.end());
+                return parse_result(label, result);
+            }
+
+        }
+
+        if (!words.empty() && words.back().size() > 2 && words.back().front() == '[' && words.back().back() == ']') {
+            return parse_result(words.back().substr(1, words.back().size() - 2), result);
+        }
+
+        return false;
+
+    }
+
+    // Start of the first line which begins at or after the given offset
+    static size_t line_start(const std::string& text, const size_t offset) {
+
+        if (offset == 0) {
+            return 0;
+        }
+
+        const size_t lineBreak = text.find('\n', offset - 1);
+
+        return lineBreak == std::string::npos ? text.size() : lineBreak + 1;
+
+    }
+
+    // Convert a text file with labelled positions into a dataset file on the threads of the pool.
+    // The file is read in blocks of whole lines, every thread converts its share of a block and
+    // the positions are written in their original order. Returns the number of converted
+    // positions, lines without a valid position and result are skipped
+    uint64_t convert(const std::string& input, const std::string& output, const unsigned threadCount, uint64_t& skipped) {
+
+        static constexpr size_t BlockSize = 16 << 20;
+
+        std::ifstream file(input, std::ios::binary);
+        Writer writer;
+
+        skipped = 0;
+
+        if (!file.is_open() || !writer.open(output)) {
+            return 0;
+        }
+
+        Threads.resize(threadCount);
+
+        std::vector<std::vector<PackedPosition>> positions(Threads.get_thread_count());
+        std::vector<uint64_t> skippedLines(Threads.get_thread_count());
+        std::string block, rest;
+        uint64_t converted = 0;
+
+        while (file) {
+
+            // Read the next block and keep an incomplete last line for the following block
+            block = rest;
+            block.resize(rest.size() + BlockSize);
+            file.read(&block[rest.size()], BlockSize);
+            block.resize(rest.size() + file.gcount());
+
+            const size_t lastLineBreak = block.rfind('\n');
+            const size_t end = (file && lastLineBreak != std::string::npos) ? lastLineBreak + 1 : block.size();
+            rest = block.substr(end);
+            block.resize(end);
+
+            Threads.start_jobs([&](Thread& thread) {
+
+                const unsigned index = thread.get_index();
+                const size_t first   = line_start(block, block.size() * index / positions.size());
+                const size_t last    = line_start(block, block.size() * (index + 1) / positions.size());
+
+                Board board;
+                std::string line, fen;
+                GameResult result;
+
+                for (size_t begin = first; begin < last; ) {
+
+                    size_t lineEnd = block.find('\n', begin);
+                    if (lineEnd == std::string::npos || lineEnd > last) {
+                        lineEnd = last;
+                    }
+
+                    line.assign(block, begin, lineEnd - begin);
+                    begin = lineEnd + 1;
+
+                    if (!line.empty() && line.back() == '\r') {
+                        line.pop_back();
+                    }
+
+                    if (line.empty() || line[0] == '#') {
+                        continue;
+                    }
+
+                    if (!parse_labelled_line(line, fen, result)) {
+                        skippedLines[index]++;
+                        continue;
+                    }
+
+                    board.set_fen(fen);
+                    positions[index].push_back(pack(board, result, VALUE_NONE));
+
+                }
+
+            });
+
+            Threads.wait_until_finished();
+            Threads.stop_searching();
+
+            for (std::vector<PackedPosition>& threadPositions : positions) {
+                for (const PackedPosition& position : threadPositions) {
+                    writer.write(position);
+                }
+                converted += threadPositions.size();
+                threadPositions.clear();
+            }
+
+        }
+
+        for (const uint64_t lines : skippedLines) {
+            skipped += lines;
+        }
+
+        Threads.resize(ThreadsOption.get_value());
+
+        return converted;
+
+    }
+
+    // Open a dataset file for writing. When appending to a valid dataset file, a partially
+    // written record at its end (e.g. after a crash) is removed first
+    bool Writer::open(const std::string& filename, const bool append) {
+
+        close();
+
+        // Only append to files which already contain a valid header
+        bool hasHeader = false;
+        if (append) {
+            std::ifstream existing(filename, std::ios::binary);
+            FileHeader header;
+            hasHeader = existing.read(reinterpret_cast<char*>(&header), sizeof(header))
+                     && std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) == 0
+                     && header.version == FileVersion;
+        }
+
+        if (hasHeader) {
+            std::error_code error;
+            const uintmax_t size = std::filesystem::file_size(filename, error);
+            if (!error && size % sizeof(PackedPosition) != 0) {
+                std::filesystem::resize_file(filename, size - size % sizeof(PackedPosition), error);
+            }
+        }
+
+        file.open(filename, std::ios::binary | (hasHeader ? std::ios::app : std::ios::trunc));
+        buffer.reserve(BufferSize);
+
+        if (file.is_open() && !hasHeader) {
+            FileHeader header = {};
+            std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+            header.version = FileVersion;
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        return file.is_open();
+
+    }
+
+    void Writer::close() {
+
+        if (file.is_open()) {
+            flush();
+            file.close();
+        }
+
+    }
+
+    void Writer::flush() {
+
+        if (file.is_open() && !buffer.empty()) {
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(PackedPosition));
+            file.flush();
+        }
+
+        buffer.clear();
+
+    }
+
+    // Map a dataset file into memory and check its header. A partially written record at the
+    // end of the file is ignored
+    bool Reader::open(const std::string& filename) {
+
+        close();
+
+        const char* data;
+        size_t size;
+
+#ifndef _WIN32
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == -1 || size_t(fileStat.st_size) < sizeof(FileHeader)) {
+            ::close(fd);
+            return false;
+        }
+
+        size = fileStat.st_size;
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (address == MAP_FAILED) {
+            return false;
+        }
+
+        madvise(address, size, MADV_SEQUENTIAL);
+
+        mapping = address;
+        mappingSize = size;
+        data = static_cast<const char*>(address);
+#else
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file || size_t(file.tellg()) < sizeof(FileHeader)) {
+            return false;
+        }
+
+        size = file.tellg();
+        buffer.resize(size / sizeof(PackedPosition));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(PackedPosition));
+        data = reinterpret_cast<const char*>(buffer.data());
+#endif
+
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(FileHeader));
+
+        if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion) {
+            close();
+            return false;
+        }
+
+        positions = reinterpret_cast<const PackedPosition*>(data + sizeof(FileHeader));
+        count = (size - sizeof(FileHeader)) / sizeof(PackedPosition);
+
+        return true;
+
+    }
+
+    void Reader::close() {
+
+#ifndef _WIN32
+        if (mapping != nullptr) {
+            munmap(mapping, mappingSize);
+            mapping = nullptr;
+        }
+#endif
+
+        buffer.clear();
+        positions = nullptr;
+        count = 0;
+
+    }
+
+}
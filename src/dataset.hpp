@@ -0,0 +1,121 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+#include "board.hpp"
+
+// Labelled positions in a compact binary format, used by the evaluation tuner.
+// A dataset file starts with a header followed by fixed size records. The number
+// of records follows from the file size, so files can be appended to
+
+namespace Dataset {
+
+    // Game result from white's point of view
+    enum GameResult : uint8_t {
+
+        RESULT_BLACK_WIN, RESULT_DRAW, RESULT_WHITE_WIN,
+        RESULT_COUNT
+
+    };
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        char reserved[24];
+    };
+
+    static_assert(sizeof(FileHeader) == sizeof(PackedPosition), "The header should be record aligned");
+
+    extern PackedPosition pack(const Board& board, const GameResult result, const int score);
+    extern bool parse_position(std::istringstream& ss, std::string& fen);
+    extern bool parse_labelled_line(const std::string& line, std::string& fen, GameResult& result);
+    extern uint64_t convert(const std::string& input, const std::string& output, const unsigned threadCount, uint64_t& skipped);
+
+    // Buffered writer for dataset files
+    class Writer {
+
+        public:
+
+            Writer() = default;
+            Writer(const Writer&) = delete;
+            Writer& operator=(const Writer&) = delete;
+            ~Writer() { close(); }
+
+            bool open(const std::string& filename, const bool append = false);
+            void close();
+            void flush();
+            bool is_open() const { return file.is_open(); }
+
+            inline void write(const PackedPosition& position) {
+                buffer.push_back(position);
+                if (buffer.size() == BufferSize) {
+                    flush();
+                }
+            }
+
+        private:
+
+            static constexpr unsigned BufferSize = 1 << 14;
+
+            std::ofstream file;
+            std::vector<PackedPosition> buffer;
+
+    };
+
+    // Read-only view of a dataset file, which is mapped into memory where possible
+    class Reader {
+
+        public:
+
+            Reader() = default;
+            Reader(const Reader&) = delete;
+            Reader& operator=(const Reader&) = delete;
+            ~Reader() { close(); }
+
+            bool open(const std::string& filename);
+            void close();
+
+            inline uint64_t size() const { return count; }
+            inline const PackedPosition& operator[](const uint64_t index) const { return positions[index]; }
+
+        private:
+
+            const PackedPosition* positions = nullptr;
+            uint64_t count = 0;
+            void* mapping = nullptr;
+            size_t mappingSize = 0;
+            std::vector<PackedPosition> buffer;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,243 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#include "engine.hpp"
+#include "libdelocto.h"
+#include "bitboards.hpp"
+#include "dataset.hpp"
+#include "evaluate.hpp"
+#include "hashkeys.hpp"
+#include "uci.hpp"
+
+Engine::Engine() : thread(new Thread(0, true)) {
+
+    thread->pawnTable.set_size(PawnHashOption.get_value());
+    thread->evalCache.set_size(EvalCacheOption.get_value());
+
+    board.set_fen(INITIAL_POSITION_FEN);
+
+}
+
+Engine::~Engine() {
+
+    stop();
+    wait();
+    thread->destroy();
+
+}
+
+// Initialize the engine tables. Has to be called once before the first instance is created
+void Engine::init() {
+
+    static std::once_flag initialized;
+
+    std::call_once(initialized, [] {
+        Hash::init();
+        Bitboards::init();
+        Eval::init();
+        Search::init();
+        UCI::init();
+    });
+
+}
+
+// Resize the shared transposition table. No instance may be searching
+void Engine::set_hash_size(const unsigned megabytes) {
+
+    HashOption.set_value(int(megabytes));
+    TTable.set_size(HashOption.get_value());
+
+}
+
+// Set the position from a FEN string. Returns false and keeps the previous position if the string is invalid
+bool Engine::set_position(const std::string& fen) {
+
+    std::istringstream ss(fen);
+    std::string validFen;
+
+    if (!Dataset::parse_position(ss, validFen)) {
+        return false;
+    }
+
+    Board position;
+    position.set_fen(validFen);
+
+    if (!position.is_opponent_safe()) {
+        return false;
+    }
+
+    board = position;
+
+    return true;
+
+}
+
+// Set the position from a packed position. Returns false and keeps the previous position if it is invalid
+bool Engine::set_position(const PackedPosition& packed) {
+
+    Board position;
+
+    if (!position.from_packed(packed)) {
+        return false;
+    }
+
+    board = position;
+
+    return true;
+
+}
+
+// Start searching the current position and return immediately. The callback is called on the
+// search thread when the search has finished, it must not start another search of this instance
+void Engine::search(const SearchLimits& limits, const Callback& callback) {
+
+    wait();
+
+    // The search is set up before the thread is woken up, so that stop() can not be missed
+    thread->prepare_alone(board, limits);
+    thread->start_job([callback](Thread& t) {
+        const SearchResult result = t.run_alone();
+        if (callback) {
+            callback(result);
+        }
+    });
+
+}
+
+// Search the current position and wait for the result
+SearchResult Engine::search(const SearchLimits& limits) {
+
+    SearchResult result;
+
+    search(limits, [&result](const SearchResult& r) { result = r; });
+    wait();
+
+    return result;
+
+}
+
+void Engine::stop() {
+
+    thread->stop_alone();
+
+}
+
+void Engine::wait() {
+
+    thread->wait();
+
+}
+
+// C interface, see libdelocto.h
+
+struct DeloctoEngine {
+    Engine engine;
+};
+
+static void copy_move(char* destination, const Move move) {
+
+    const std::string string = move != MOVE_NONE ? move_to_string(move) : "";
+    std::strncpy(destination, string.c_str(), 6);
+    destination[5] = '\0';
+
+}
+
+static void convert_result(const SearchResult& result, DeloctoResult& converted) {
+
+    copy_move(converted.bestMove, result.bestMove);
+
+    converted.isMate = std::abs(result.value) >= VALUE_MATE_MAX;
+    converted.score  = converted.isMate ? mate_distance(result.value) : result.value;
+    converted.depth  = result.depth;
+    converted.nodes  = result.nodes;
+
+    converted.pvLength = std::min(int(result.pv.size()), DELOCTO_PV_MAX);
+    for (int i = 0; i < converted.pvLength; i++) {
+        copy_move(converted.pv[i], result.pv[i]);
+    }
+
+}
+
+extern "C" {
+
+    void delocto_init(void) {
+        Engine::init();
+    }
+
+    void delocto_set_hash_size(unsigned megabytes) {
+        Engine::set_hash_size(megabytes);
+    }
+
+    DeloctoEngine* delocto_engine_new(void) {
+        return new DeloctoEngine();
+    }
+
+    void delocto_engine_free(DeloctoEngine* engine) {
+        delete engine;
+    }
+
+    int delocto_set_fen(DeloctoEngine* engine, const char* fen) {
+        return engine->engine.set_position(std::string(fen));
+    }
+
+    int delocto_set_packed(DeloctoEngine* engine, const void* position) {
+        PackedPosition packed;
+        std::memcpy(&packed, position, sizeof(PackedPosition));
+        return engine->engine.set_position(packed);
+    }
+
+    void delocto_search(DeloctoEngine* engine, const DeloctoLimits* limits, DeloctoCallback callback, void* userData) {
+
+        SearchLimits searchLimits;
+        if (limits->depth > 0) {
+            searchLimits.depth = std::min(limits->depth, DEPTH_MAX);
+        }
+        searchLimits.nodes    = limits->nodes;
+        searchLimits.moveTime = std::max(limits->moveTime, int64_t(0));
+        searchLimits.infinite = !limits->depth && !limits->nodes && !limits->moveTime;
+
+        engine->engine.search(searchLimits, [callback, userData](const SearchResult& result) {
+            if (callback) {
+                DeloctoResult converted = {};
+                convert_result(result, converted);
+                callback(&converted, userData);
+            }
+        });
+
+    }
+
+    void delocto_stop(DeloctoEngine* engine) {
+        engine->engine.stop();
+    }
+
+    void delocto_wait(DeloctoEngine* engine) {
+        engine->engine.wait();
+    }
+
+}
@@ -0,0 +1,71 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "types.hpp"
+#include "board.hpp"
+#include "search.hpp"
+#include "thread.hpp"
+
+// An engine instance for embedding the engine into other programs without the UCI loop.
+// Every instance searches on its own standalone thread with its own board, histories,
+// pawn table and evaluation cache, so several instances can search at the same time.
+// All instances share the transposition table. The C interface is in libdelocto.h
+class Engine {
+
+    public:
+
+        using Callback = std::function<void(const SearchResult&)>;
+
+        Engine();
+        Engine(const Engine&) = delete;
+        Engine& operator=(const Engine&) = delete;
+        ~Engine();
+
+        static void init();
+        static void set_hash_size(const unsigned megabytes);
+
+        bool set_position(const std::string& fen);
+        bool set_position(const PackedPosition& position);
+        const Board& get_position() const { return board; }
+
+        void search(const SearchLimits& limits, const Callback& callback);
+        SearchResult search(const SearchLimits& limits);
+        void stop();
+        void wait();
+
+    private:
+
+        Board board;
+        std::unique_ptr<Thread> thread; // Too large for the stack
+
+};
+
+#endif
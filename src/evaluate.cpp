@@ -27,9 +27,17 @@
 
 EvalTerm PieceSquareTable[2][6][64];
 
+#ifdef EVAL_TUNE
+// The trace recorded by the running evaluation, only set while tracing
+static thread_local EvalTrace* Trace = nullptr;
+#define TRACE_EVAL(statement) do { if (Trace) { Trace->statement; } } while (false)
+#else
+#define TRACE_EVAL(statement) ((void)0)
+#endif
+
 // Piece Square Table Values
 // The values are mirrored for each color at execution time
-static const EvalTerm PstValues[6][32] = {
+static constexpr EvalTerm PstValues[6][32] = {
 
     // Pawns
     {
@@ -134,14 +142,25 @@ static const int Imbalance[2][6][6] = {
 
 };
 
+// Material table
+// Imbalance values and game phases are precomputed for every combination of up to eight pawns and
+// two knights, bishops and rooks and one queen per side, indexed by the piece counts of both sides.
+// Any other material configuration requires an underpromotion or a second queen and is computed directly
+static constexpr unsigned MaterialCountLimits[5] = { 9, 3, 3, 3, 2 };
+static constexpr unsigned MaterialSideCount      = 9 * 3 * 3 * 3 * 2;
+static constexpr unsigned NonPawnSideCount       = MaterialSideCount / 9;
+
+static int16_t MaterialImbalance[MaterialSideCount][MaterialSideCount];
+static uint8_t MaterialPhase[NonPawnSideCount][NonPawnSideCount];
+
 // Bitboards for outposts and boni for having minors on those squares or attacking them
 static const Bitboard OutpostSquares[2]        = { BB_RANK_3 | BB_RANK_4 | BB_RANK_5, BB_RANK_6 | BB_RANK_5 | BB_RANK_4 };
-static const EvalTerm OutpostBonus[2]          = { V(34, 11), V(17, 6) };
-static const EvalTerm OutpostReachableBonus[2] = { V(17,  6), V( 8, 3) };
+static constexpr EvalTerm OutpostBonus[2]          = { V(34, 11), V(17, 6) };
+static constexpr EvalTerm OutpostReachableBonus[2] = { V(17,  6), V( 8, 3) };
 
 // Mobilty Values
 // The more squares available to the piece, the higher the value
-static const EvalTerm Mobility[4][28] = {
+static constexpr EvalTerm Mobility[4][28] = {
 
     // Knights
     { V(-29, -35), V(-22, -25), V(-5, -12), V(-2, -6), V(2, 4), V(6, 8), V(9, 11), V(12, 14), V(14, 15) },
@@ -155,47 +174,47 @@ static const EvalTerm Mobility[4][28] = {
 };
 
 // Pawns
-static const EvalTerm pawnDoubledPenalty           = V(8, 14);
-static const EvalTerm pawnIsolatedPenalty[2]       = { V(11, 12), V(5, 7) };
-static const EvalTerm pawnBackwardPenalty[2]       = { V(17, 11), V(10, 5) };
-static const EvalTerm pawnLeverBonus[8]            = { V(0, 0), V(0, 0), V(0, 0), V(0, 0), V(7, 6), V(13, 13), V(0, 0), V(0, 0) };
+static constexpr EvalTerm pawnDoubledPenalty           = V(8, 14);
+static constexpr EvalTerm pawnIsolatedPenalty[2]       = { V(11, 12), V(5, 7) };
+static constexpr EvalTerm pawnBackwardPenalty[2]       = { V(17, 11), V(10, 5) };
+static constexpr EvalTerm pawnLeverBonus[8]            = { V(0, 0), V(0, 0), V(0, 0), V(0, 0), V(7, 6), V(13, 13), V(0, 0), V(0, 0) };
 static const int pawnConnectedBonus[8] = {
 
     0, 3, 4, 6, 14, 23, 40, 0
 
 };
-static const EvalTerm pawnPhalanxBonus[2][8] = {
+static constexpr EvalTerm pawnPhalanxBonus[2][8] = {
 
     { V(0, 0), V(8, 0), V(9, 0), V(16, 2), V(37, 18), V(57, 43), V(105, 105), V(0, 0) },
     { V(0, 0), V(4, 0), V(4, 0), V( 9, 1), V(18,  9), V(29, 21), V( 52,  52), V(0, 0) }
 
 };
-static const EvalTerm pawnSupportBonus             = V(6, 2);
-static const EvalTerm pawnPassedRankBonus[8]       = { V(0, 0), V(4, 13), V(8, 15), V(7, 19), V(29, 34), V(79, 83), V(130, 122), V(0, 0) };
-static const EvalTerm pawnPassedFilePenalty[8]     = { V(0, 0), V(5, 4), V(10, 8), V(15, 12), V(15, 12), V(10, 8), V(5, 4), V(0, 0) };
-static const EvalTerm pawnCandidateBonus[8]        = { V(0, 0), V(0, 0), V(5, 15),  V(10, 30), V(20, 45), V(30, 50),   V(40, 60),   V(0, 0) };
+static constexpr EvalTerm pawnSupportBonus             = V(6, 2);
+static constexpr EvalTerm pawnPassedRankBonus[8]       = { V(0, 0), V(4, 13), V(8, 15), V(7, 19), V(29, 34), V(79, 83), V(130, 122), V(0, 0) };
+static constexpr EvalTerm pawnPassedFilePenalty[8]     = { V(0, 0), V(5, 4), V(10, 8), V(15, 12), V(15, 12), V(10, 8), V(5, 4), V(0, 0) };
+static constexpr EvalTerm pawnCandidateBonus[8]        = { V(0, 0), V(0, 0), V(5, 15),  V(10, 30), V(20, 45), V(30, 50),   V(40, 60),   V(0, 0) };
 
-static const EvalTerm passedPawnNoAttacks          = V(16, 18);
-static const EvalTerm passedPawnSafePath           = V( 9, 11);
-static const EvalTerm passedPawnSafePush           = V( 4,  6);
-static const EvalTerm passedPawnBlockSqDefended    = V( 2,  3);
+static constexpr EvalTerm passedPawnNoAttacks          = V(16, 18);
+static constexpr EvalTerm passedPawnSafePath           = V( 9, 11);
+static constexpr EvalTerm passedPawnSafePush           = V( 4,  6);
+static constexpr EvalTerm passedPawnBlockSqDefended    = V( 2,  3);
 
 // Bishops
-static const EvalTerm bishopPawnsSameColorPenalty  = V( 1,  3);
-static const EvalTerm bishopCenterAlignBonus       = V(21,  0);
+static constexpr EvalTerm bishopPawnsSameColorPenalty  = V( 1,  3);
+static constexpr EvalTerm bishopCenterAlignBonus       = V(21,  0);
 
 // Minors
-static const EvalTerm OutpostReachable[2]          = { V(8, 0), V(4, 0) };
-static const EvalTerm minorPawnShield              = V(8, 1);
+static constexpr EvalTerm OutpostReachable[2]          = { V(8, 0), V(4, 0) };
+static constexpr EvalTerm minorPawnShield              = V(8, 1);
 
 // Rooks
-static const EvalTerm rookOpenFileBonus      = V(19,  9);
-static const EvalTerm rookSemiOpenFileBonus  = V( 6,  4);
-static const EvalTerm rookPawnAlignBonus     = V( 3, 12);
-static const EvalTerm rookTrappedPenalty     = V(22,  2);
+static constexpr EvalTerm rookOpenFileBonus      = V(19,  9);
+static constexpr EvalTerm rookSemiOpenFileBonus  = V( 6,  4);
+static constexpr EvalTerm rookPawnAlignBonus     = V( 3, 12);
+static constexpr EvalTerm rookTrappedPenalty     = V(22,  2);
 
 // Queens
-static const EvalTerm UnsafeQueen = V(23, 7);
+static constexpr EvalTerm UnsafeQueen = V(23, 7);
 
 // King
 static const unsigned queenSafeCheckWeight       = 365;
@@ -210,9 +229,9 @@ static const unsigned kingKnightDefender         =  47;
 static const unsigned kingBishopDefender         =  18;
 static const unsigned kingNoQueenAttacker        = 410;
 static const unsigned attackerWeight[5]          = { 0, 36, 26, 21, 5 };
-static const EvalTerm kingPawnlessFlank             = V(8, 45);
-static const EvalTerm kingFlankAttack               = V(4,  0);
-static const EvalTerm kingProtectorDistancePenalty  = V(3,  4);
+static constexpr EvalTerm kingPawnlessFlank             = V(8, 45);
+static constexpr EvalTerm kingFlankAttack               = V(4,  0);
+static constexpr EvalTerm kingProtectorDistancePenalty  = V(3,  4);
 
 static const int kingPawnShelterValues[4][8] = {
 
@@ -233,29 +252,133 @@ static const int kingPawnStormValues[4][8] = {
 };
 
 // Threats
-static const EvalTerm safePawnAttack          = V(85, 46);
-static const EvalTerm loosePawnWeight         = V(16, 28);
-static const EvalTerm HangingPiece            = V(32, 17);
-static const EvalTerm pawnPushThreat          = V(20, 12);
-static const EvalTerm pieceVulnerable         = V( 6,  0);
-static const EvalTerm mobilityRestriction     = V( 3,  3);
-static const EvalTerm KnightQueenAttackThreat = V( 8,  6);
-static const EvalTerm BishopQueenAttackThreat = V(28,  8);
-static const EvalTerm RookQueenAttackThreat   = V(28,  8);
-static const EvalTerm KingAttackThreat        = V(11, 42);
-static const EvalTerm minorAttackWeight[PIECETYPE_COUNT] = {
+static constexpr EvalTerm safePawnAttack          = V(85, 46);
+static constexpr EvalTerm loosePawnWeight         = V(16, 28);
+static constexpr EvalTerm HangingPiece            = V(32, 17);
+static constexpr EvalTerm pawnPushThreat          = V(20, 12);
+static constexpr EvalTerm pieceVulnerable         = V( 6,  0);
+static constexpr EvalTerm mobilityRestriction     = V( 3,  3);
+static constexpr EvalTerm KnightQueenAttackThreat = V( 8,  6);
+static constexpr EvalTerm BishopQueenAttackThreat = V(28,  8);
+static constexpr EvalTerm RookQueenAttackThreat   = V(28,  8);
+static constexpr EvalTerm KingAttackThreat        = V(11, 42);
+static constexpr EvalTerm minorAttackWeight[PIECETYPE_COUNT] = {
     V(0, 15), V(19, 20), V(28, 22), V(34, 55), V(30, 59), V(0, 0)
 };
-static const EvalTerm rookAttackWeight[PIECETYPE_COUNT] = {
+static constexpr EvalTerm rookAttackWeight[PIECETYPE_COUNT] = {
     V(0, 11), V(18, 34), V(16, 32), V( 0, 17), V(25, 19), V(0, 0)
 };
 
 // Tempo Bonus
 static const int tempoBonus = 12;
 
+// Margin by which the partial evaluation has to be outside of the window for a lazy evaluation
+static const int LazyMargin = 300;
+
 static int kingPawnShelter[8][8];
 static int kingPawnStorm[8][8];
 
+// Computes the phase for the given number of pieces of both sides (inspired by Fruit chess engine by Fabien Letouzy)
+// The phase determines whether the midgame or endgame term should have more weight
+// If there are less pieces left on the board, this means we are usually in an endgame
+static Phase compute_phase(const unsigned knights, const unsigned bishops, const unsigned rooks, const unsigned queens) {
+
+    static const int MaterialLimitMG = 76; // Sum of all piece values in starting position
+    static const int MaterialLimitEG = 8;
+
+    int material = std::clamp(int(14 * queens + 6 * rooks + 3 * (bishops + knights)), MaterialLimitEG, MaterialLimitMG);
+
+    // Based on the material, we calculate the phase which is somewhere between PHASE_ENDGAME and PHASE_MIDGAME
+    return Phase((material - MaterialLimitEG) * PHASE_MIDGAME / (MaterialLimitMG - MaterialLimitEG));
+
+}
+
+// Computes the material imbalance for the given color. The piece counts of each color start with
+// the bishop pair, followed by the number of pawns, knights, bishops, rooks and queens
+static int compute_imbalance(const unsigned pieceCounts[2][6], const Color color) {
+
+    int value = 0;
+
+    // Loop over all piece types
+    for (unsigned pt1index = 0; pt1index <= 5; pt1index++) {
+
+        if (pieceCounts[color][pt1index] > 0) {
+
+            int v = 0;
+
+            // Loop over all the piece types again, and add the imbalance value based
+            // on how many pieces are on the board
+            for (unsigned pt2index = 0; pt2index <= pt1index; pt2index++) {
+                v += Imbalance[0][pt1index][pt2index] * pieceCounts[color][pt2index] + Imbalance[1][pt1index][pt2index] * pieceCounts[!color][pt2index];
+            }
+
+            // Multiply the value with the number of pieces of the current type
+            value += v * pieceCounts[color][pt1index];
+
+        }
+
+    }
+
+    return value;
+
+}
+
+// Fill the material table with the imbalance and phase of every material configuration it covers
+static void init_material_table() {
+
+    unsigned counts[2][5];
+    unsigned pieceCounts[2][6];
+
+    for (unsigned whiteIndex = 0; whiteIndex < MaterialSideCount; whiteIndex++) {
+        for (unsigned blackIndex = 0; blackIndex < MaterialSideCount; blackIndex++) {
+
+            // Decode the piece counts of both sides, the number of pawns is the most significant digit
+            unsigned indices[2] = { whiteIndex, blackIndex };
+            for (Color c = WHITE; c < BOTH; ++c) {
+                for (int pt = QUEEN; pt >= int(PAWN); pt--) {
+                    counts[c][pt] = indices[c] % MaterialCountLimits[pt];
+                    indices[c] /= MaterialCountLimits[pt];
+                }
+                pieceCounts[c][0] = counts[c][BISHOP] > 1;
+                for (Piecetype pt = PAWN; pt <= QUEEN; ++pt) {
+                    pieceCounts[c][pt + 1] = counts[c][pt];
+                }
+            }
+
+            const int imbalance = compute_imbalance(pieceCounts, WHITE) - compute_imbalance(pieceCounts, BLACK);
+            assert(imbalance >= std::numeric_limits<int16_t>::min() && imbalance <= std::numeric_limits<int16_t>::max());
+            MaterialImbalance[whiteIndex][blackIndex] = imbalance;
+
+            MaterialPhase[whiteIndex % NonPawnSideCount][blackIndex % NonPawnSideCount] = compute_phase(
+                counts[WHITE][KNIGHT] + counts[BLACK][KNIGHT],
+                counts[WHITE][BISHOP] + counts[BLACK][BISHOP],
+                counts[WHITE][ROOK]   + counts[BLACK][ROOK],
+                counts[WHITE][QUEEN]  + counts[BLACK][QUEEN]
+            );
+
+        }
+    }
+
+}
+
+// Index of the piece counts of a color in the material table. Returns MaterialSideCount if
+// the counts exceed the limits of the table
+static inline unsigned material_index(const Board& board, const Color color) {
+
+    unsigned index = 0;
+
+    for (Piecetype pt = PAWN; pt <= QUEEN; ++pt) {
+        const unsigned count = board.piece_count(color, pt);
+        if (count >= MaterialCountLimits[pt]) {
+            return MaterialSideCount;
+        }
+        index = index * MaterialCountLimits[pt] + count;
+    }
+
+    return index;
+
+}
+
 // Initialize the piece square tables
 void init_psqt() {
 
@@ -296,6 +419,7 @@ namespace Eval {
         }
 
         init_psqt();
+        init_material_table();
 
     }
 }
@@ -313,26 +437,10 @@ bool Board::is_material_draw() const {
 
 }
 
-// Computes the phase of the current position (inspired by Fruit chess engine by Fabien Letouzy)
-// The phase determines whether the midgame or endgame term should have more weight
-// If there are less pieces left on the board, this means we are usually in an endgame
+// Computes the phase of the current position
 static Phase compute_phase(const Board& board) {
 
-    static const int MaterialLimitMG = 76; // Sum of all piece values in starting position
-    static const int MaterialLimitEG = 8;
-
-    int material = std::clamp(
-        int(
-            14 * board.piece_count(QUEEN) +
-            6 * board.piece_count(ROOK) +
-            3 * (board.piece_count(BISHOP) + board.piece_count(KNIGHT))
-        ),
-        MaterialLimitEG,
-        MaterialLimitMG
-    );
-
-    // Based on the material, we calculate the phase which is somewhere between PHASE_ENDGAME and PHASE_MIDGAME
-    return Phase((material - MaterialLimitEG) * PHASE_MIDGAME / (MaterialLimitMG - MaterialLimitEG));
+    return compute_phase(board.piece_count(KNIGHT), board.piece_count(BISHOP), board.piece_count(ROOK), board.piece_count(QUEEN));
 
 }
 
@@ -341,7 +449,7 @@ static ScaleFactor compute_scale_factor(const Board& board, const EvalTerm value
 
     int factor = SCALE_FACTOR_NORMAL;
 
-    const Color strong = value.mg > 0 ? WHITE : BLACK;
+    const Color strong = value.mg() > 0 ? WHITE : BLACK;
     const Color weak = !strong;
     const Bitboard minorsAndRooks = board.pieces(KNIGHT) | board.pieces(BISHOP) | board.pieces(ROOK);
     const bool pawnsBothHalves = (board.pieces(PAWN) & KING_HALF) && (board.pieces(PAWN) & QUEEN_HALF);
@@ -382,8 +490,8 @@ static int scale_evaluation(const Board& board, const int phase, const EvalTerm
 
     const ScaleFactor scaleFactor = compute_scale_factor(board, value);
 
-    return   (value.mg * phase
-           +  value.eg * (PHASE_MIDGAME - phase) * scaleFactor / SCALE_FACTOR_NORMAL) / PHASE_MIDGAME;
+    return   (value.mg() * phase
+           +  value.eg() * (PHASE_MIDGAME - phase) * scaleFactor / SCALE_FACTOR_NORMAL) / PHASE_MIDGAME;
 
 }
 
@@ -403,6 +511,7 @@ static void update_attack_info(Color color, Piecetype pt, Bitboard moves, EvalIn
         info.kingAttackersWeight[!color] += attackerWeight[pt];
         info.kingAttackersNum[!color]++;
         info.kingRingAttacks[!color] += popcount(kingAttacks);
+        TRACE_EVAL(kingAttackers[!color][pt]++);
     }
 
 }
@@ -411,36 +520,48 @@ static void update_attack_info(Color color, Piecetype pt, Bitboard moves, EvalIn
 static const EvalTerm evaluate_knights(const Board& board, const Color color, EvalInfo& info) {
 
     EvalTerm value;
+    EvalTerm mobility;
+
+    // Masks which are the same for all knights
+    const Bitboard pinned       = board.get_king_blockers(color);
+    const Bitboard outposts     = OutpostSquares[color] & info.pieceAttacks[color][PAWN] & ~info.pawnAttacksSpan[!color];
+    const Bitboard reachable    = outposts & ~board.pieces(color);
+    const Bitboard shielded     = shift_down(board.pieces(PAWN), color);
+    const Bitboard mobilityArea = info.mobilityArea[color];
+    const Square kingSq         = info.kingSq[color];
+
     Bitboard knights = board.pieces(color, KNIGHT);
     while (knights) {
 
         Square sq = pop_lsb(knights);
         Bitboard moves = piece_attacks<KNIGHT>(sq);
-        if (board.get_king_blockers(color) & SQUARES[sq]) {
-            moves &= LineTable[sq][info.kingSq[color]];
+        if (pinned & SQUARES[sq]) {
+            moves &= LineTable[sq][kingSq];
         }
 
         // Bonus for outposts
-        Bitboard outposts = OutpostSquares[color] & info.pieceAttacks[color][PAWN] & ~info.pawnAttacksSpan[!color];
         if (outposts & SQUARES[sq]) {
             value += OutpostBonus[0];
-        } else if (outposts & moves & ~board.pieces(color)) {
+        } else if (reachable & moves) {
             value += OutpostReachableBonus[0];
         }
 
         // Bonus for being behind a friendly pawn
-        if (SQUARES[sq] & shift_down(board.pieces(PAWN), color)) {
+        if (SQUARES[sq] & shielded) {
             value += minorPawnShield;
         }
 
         // Penalty for being far away from the king
-        value -= kingProtectorDistancePenalty * KingDistance[sq][info.kingSq[color]];
+        value -= kingProtectorDistancePenalty * KingDistance[sq][kingSq];
 
-        info.mobility[color] += Mobility[0][popcount(moves & info.mobilityArea[color])];
+        mobility += Mobility[0][popcount(moves & mobilityArea)];
+        TRACE_EVAL(terms[color][TUNE_MOBILITY + 0 * 28 + popcount(moves & mobilityArea)]++);
         update_attack_info(color, KNIGHT, moves, info);
 
     }
 
+    info.mobility[color] += mobility;
+
     return value;
 
 }
@@ -449,6 +570,17 @@ static const EvalTerm evaluate_knights(const Board& board, const Color color, Ev
 static const EvalTerm evaluate_bishops(const Board& board, const Color color, EvalInfo& info) {
 
     EvalTerm value;
+    EvalTerm mobility;
+
+    // Masks which are the same for all bishops
+    const Bitboard pinned       = board.get_king_blockers(color);
+    const Bitboard occupied     = board.pieces(BOTH) & ~board.pieces(QUEEN); // Exclude queens for xrays
+    const Bitboard outposts     = OutpostSquares[color] & info.pieceAttacks[color][PAWN] & ~info.pawnAttacksSpan[!color];
+    const Bitboard reachable    = outposts & ~board.pieces(color);
+    const Bitboard shielded     = shift_down(board.pieces(PAWN), color);
+    const Bitboard mobilityArea = info.mobilityArea[color];
+    const Square kingSq         = info.kingSq[color];
+    const int blockedCentralPawns = popcount(info.blockedPawns[color] & CENTRAL_FILES);
 
     Bitboard bishops = board.pieces(color, BISHOP);
 
@@ -456,29 +588,27 @@ static const EvalTerm evaluate_bishops(const Board& board, const Color color, Ev
 
         Square sq = pop_lsb(bishops);
 
-        // Exclude queen for xrays
-        Bitboard moves = piece_attacks<BISHOP>(sq, board.pieces(BOTH) & ~board.pieces(QUEEN));
-        if (board.get_king_blockers(color) & SQUARES[sq]) {
-            moves &= LineTable[sq][info.kingSq[color]];
+        Bitboard moves = piece_attacks<BISHOP>(sq, occupied);
+        if (pinned & SQUARES[sq]) {
+            moves &= LineTable[sq][kingSq];
         }
 
         // Bonus for outposts
-        Bitboard outposts = OutpostSquares[color] & info.pieceAttacks[color][PAWN] & ~info.pawnAttacksSpan[!color];
         if (outposts & SQUARES[sq]) {
             value += OutpostBonus[1];
-        } else if (outposts & moves & ~board.pieces(color)) {
+        } else if (reachable & moves) {
             value += OutpostReachableBonus[1];
         }
 
         // Bonus for being behind a friendly pawn
-        if (SQUARES[sq] & shift_down(board.pieces(PAWN), color)) {
+        if (SQUARES[sq] & shielded) {
             value += minorPawnShield;
         }
 
         // Penalty for having many pawns on the same square color as the bishop,
         // since this restricts the mobility of the bishop
         Bitboard pawnsOnSameColor = board.get_same_colored_squares(sq) & board.pieces(color, PAWN);
-        value -= bishopPawnsSameColorPenalty * popcount(pawnsOnSameColor) * (1 + popcount(info.blockedPawns[color] & CENTRAL_FILES));
+        value -= bishopPawnsSameColorPenalty * popcount(pawnsOnSameColor) * (1 + blockedCentralPawns);
 
         // Bonus for being attacking central squares
         if (popcount(piece_attacks<BISHOP>(sq, board.pieces(PAWN)) & CENTRAL_SQUARES) > 1) {
@@ -486,13 +616,16 @@ static const EvalTerm evaluate_bishops(const Board& board, const Color color, Ev
         }
 
         // Penalty for being far away from the king
-        value -= kingProtectorDistancePenalty * KingDistance[sq][info.kingSq[color]];
+        value -= kingProtectorDistancePenalty * KingDistance[sq][kingSq];
 
-        info.mobility[color] += Mobility[1][popcount(moves & info.mobilityArea[color])];
+        mobility += Mobility[1][popcount(moves & mobilityArea)];
+        TRACE_EVAL(terms[color][TUNE_MOBILITY + 1 * 28 + popcount(moves & mobilityArea)]++);
         update_attack_info(color, BISHOP, moves, info);
 
     }
 
+    info.mobility[color] += mobility;
+
     return value;
 
 }
@@ -501,20 +634,26 @@ static const EvalTerm evaluate_bishops(const Board& board, const Color color, Ev
 static const EvalTerm evaluate_rooks(const Board& board, const Color color, EvalInfo& info) {
 
     EvalTerm value;
+    EvalTerm mobility;
+
+    // Masks which are the same for all rooks
+    const Bitboard pinned       = board.get_king_blockers(color);
+    const Bitboard occupied     = board.pieces(BOTH) & ~board.majors(); // Exclude queens and rooks for xrays
+    const Bitboard mobilityArea = info.mobilityArea[color];
+    const Square kingSq         = info.kingSq[color];
 
     Bitboard rooks = board.pieces(color, ROOK);
     while (rooks) {
 
         Square sq = pop_lsb(rooks);
 
-        // Exclude queens and rooks for xrays
-        Bitboard moves = piece_attacks<ROOK>(sq, board.pieces(BOTH) & ~board.majors());
-        if (board.get_king_blockers(color) & SQUARES[sq]) {
-            moves &= LineTable[sq][info.kingSq[color]];
+        Bitboard moves = piece_attacks<ROOK>(sq, occupied);
+        if (pinned & SQUARES[sq]) {
+            moves &= LineTable[sq][kingSq];
         }
 
         const File f = file(sq);
-        const unsigned mob = popcount(moves & info.mobilityArea[color]);
+        const unsigned mob = popcount(moves & mobilityArea);
 
         // Bonus for being on an open file (no pawns)
         if (!(FILES[f] & board.pieces(PAWN))) {
@@ -524,7 +663,7 @@ static const EvalTerm evaluate_rooks(const Board& board, const Color color, Eval
             value += rookSemiOpenFileBonus;
         } else {
             // Penalty for being in the corner and having low mobility
-            const int kingFile = file(info.kingSq[color]);
+            const int kingFile = file(kingSq);
             if (mob <= 3 && ((kingFile > 3) == (f > kingFile))) {
                 value -= rookTrappedPenalty;
             }
@@ -536,11 +675,14 @@ static const EvalTerm evaluate_rooks(const Board& board, const Color color, Eval
             value += rookPawnAlignBonus * popcount(moves & board.pieces(!color, PAWN));
         }
 
-        info.mobility[color] += Mobility[2][mob];
+        mobility += Mobility[2][mob];
+        TRACE_EVAL(terms[color][TUNE_MOBILITY + 2 * 28 + mob]++);
         update_attack_info(color, ROOK, moves, info);
 
     }
 
+    info.mobility[color] += mobility;
+
     return value;
 
 }
@@ -549,26 +691,36 @@ static const EvalTerm evaluate_rooks(const Board& board, const Color color, Eval
 static const EvalTerm evaluate_queens(const Board& board, const Color color, EvalInfo& info) {
 
     EvalTerm value;
+    EvalTerm mobility;
+
+    // Masks which are the same for all queens
+    const Bitboard pinned       = board.get_king_blockers(color);
+    const Bitboard sliders      = board.pieces(!color, BISHOP) | board.pieces(!color, ROOK);
+    const Bitboard mobilityArea = info.mobilityArea[color];
+    const Square kingSq         = info.kingSq[color];
 
     Bitboard queens = board.pieces(color, QUEEN);
     while (queens) {
 
         Square sq = pop_lsb(queens);
         Bitboard moves = piece_attacks<QUEEN>(sq, board.pieces(BOTH));
-        if (board.get_king_blockers(color) & SQUARES[sq]) {
-            moves &= LineTable[sq][info.kingSq[color]];
+        if (pinned & SQUARES[sq]) {
+            moves &= LineTable[sq][kingSq];
         }
 
         // Penalty for being in a discoverd attack by a slider
-        if (board.get_slider_blockers(board.pieces(!color, BISHOP) | board.pieces(!color, ROOK), sq)) {
+        if (board.get_slider_blockers(sliders, sq)) {
             value -= UnsafeQueen;
         }
 
-        info.mobility[color] += Mobility[3][popcount(moves & info.mobilityArea[color])];
+        mobility += Mobility[3][popcount(moves & mobilityArea)];
+        TRACE_EVAL(terms[color][TUNE_MOBILITY + 3 * 28 + popcount(moves & mobilityArea)]++);
         update_attack_info(color, QUEEN, moves, info);
 
     }
 
+    info.mobility[color] += mobility;
+
     return value;
 
 }
@@ -777,11 +929,33 @@ static const EvalTerm evaluate_king_safety(const Board& board, const Color color
             + kingUnsafeCheck * popcount(unsafeChecks)
             + kingSliderBlocker * popcount(board.get_king_blockers(color))
             + 2 * flankAttacksCount / 8
-            + info.mobility[!color].mg - info.mobility[color].mg
+            + info.mobility[!color].mg() - info.mobility[color].mg()
             - kingKnightDefender * popcount(ring & info.pieceAttacks[color][KNIGHT])
             - kingBishopDefender * popcount(ring & info.pieceAttacks[color][BISHOP])
             - 6 * pawnValue / 9;
 
+#ifdef EVAL_TUNE
+    // Record how often each weight was added to the danger value
+    if (Trace) {
+        int16_t* weights = Trace->danger[color];
+        weights[DANGER_NO_QUEEN]        = -!board.pieces(!color, QUEEN);
+        weights[DANGER_QUEEN_CHECK]     = bool(queenChecks & (safeCheckSquares & ~rookChecks));
+        weights[DANGER_ROOK_CHECK]      = bool(rookChecks & safeCheckSquares);
+        weights[DANGER_BISHOP_CHECK]    = bool(bishopChecks & (safeCheckSquares & ~queenChecks));
+        weights[DANGER_KNIGHT_CHECK]    = bool(knightChecks & safeCheckSquares);
+        weights[DANGER_UNSAFE_CHECK]    = popcount(unsafeChecks);
+        weights[DANGER_RING_ATTACK]     = info.kingRingAttacks[color];
+        weights[DANGER_WEAK_SQUARE]     = popcount(ring & weakSquares);
+        weights[DANGER_SLIDER_BLOCKER]  = popcount(board.get_king_blockers(color));
+        weights[DANGER_KNIGHT_DEFENDER] = -popcount(ring & info.pieceAttacks[color][KNIGHT]);
+        weights[DANGER_BISHOP_DEFENDER] = -popcount(ring & info.pieceAttacks[color][BISHOP]);
+        for (Piecetype pt = KNIGHT; pt <= QUEEN; ++pt) {
+            weights[DANGER_ATTACKER + pt - KNIGHT] = info.kingAttackersNum[color] * Trace->kingAttackers[color][pt];
+        }
+        Trace->kingDanger[color] = danger;
+    }
+#endif
+
     /*std::cout << "Flank Attacks: " << kingFlankAttack * flankAttacksCount << std::endl;
     std::cout << "Attackers: " << (info.kingAttackersNum[color] * info.kingAttackersWeight[color]) << std::endl;
     std::cout << "Ring Attacks: " << (kingRingAttackWeight * info.kingRingAttacks[color]) << std::endl;
@@ -789,7 +963,7 @@ static const EvalTerm evaluate_king_safety(const Board& board, const Color color
     std::cout << "Unsafe Checks: " << kingUnsafeCheck * popcount(unsafeChecks) << std::endl;
     std::cout << "Slider Blockers: " << kingSliderBlocker * popcount(board.get_king_blockers(color)) << std::endl;
     std::cout << "Flank Attacks Count: " << 2 * flankAttacksCount / 8 << std::endl;
-    std::cout << "Mobility: " << (info.mobility[!color].mg - info.mobility[color].mg) << std::endl;
+    std::cout << "Mobility: " << (info.mobility[!color].mg() - info.mobility[color].mg()) << std::endl;
     std::cout << "Knight Defender: " << (kingKnightDefender * popcount(ring & info.attackedSquares[Knight(color)])) << std::endl;
     std::cout << "Bishop Defender: " << (kingBishopDefender * popcount(ring & info.attackedSquares[Bishop(color)])) << std::endl;
     std::cout << "Pawn EvalTerm: " << pawnValue << ":" << (6 * pawnValue / 9) << std::endl;
@@ -807,9 +981,11 @@ static const EvalTerm evaluate_king_safety(const Board& board, const Color color
 
     value -= kingFlankAttack * flankAttacksCount;
 
-    value.mg += pawnValue;
+    value += V(pawnValue, 0);
 
-    return V(std::min(80, value.mg), value.eg);
+    TRACE_EVAL(kingSafety[color] = value);
+
+    return V(std::min(80, value.mg()), value.eg());
 
 }
 
@@ -874,41 +1050,21 @@ static const EvalTerm evaluate_passers(const Board& board, const Color color, co
     }
 
     // No negative evaluation for passed pawns
-    return V(std::max(0, value.mg), std::max(0, value.eg));
+    return V(std::max(0, value.mg()), std::max(0, value.eg()));
 
 }
 
 // Evaluate all material imbalances on the board for the given color
 static const EvalTerm evaluate_imbalances(const Board& board, const Color color) {
 
-    EvalTerm value;
-
     const unsigned pieceCounts[2][6] = {
         { board.piece_count(WHITE, BISHOP) > 1, board.piece_count(WHITE, PAWN), board.piece_count(WHITE, KNIGHT), board.piece_count(WHITE, BISHOP), board.piece_count(WHITE, ROOK), board.piece_count(WHITE, QUEEN) },
         { board.piece_count(BLACK, BISHOP) > 1, board.piece_count(BLACK, PAWN), board.piece_count(BLACK, KNIGHT), board.piece_count(BLACK, BISHOP), board.piece_count(BLACK, ROOK), board.piece_count(BLACK, QUEEN) }
     };
 
-    // Loop over all piece types
-    for (unsigned pt1index = 0; pt1index <= 5; pt1index++) {
-
-        if (pieceCounts[color][pt1index] > 0) {
-
-            int v = 0;
-
-            // Loop over all the piece types again, and add the imbalance value based
-            // on how many pieces are on the board
-            for (unsigned pt2index = 0; pt2index <= pt1index; pt2index++) {
-                v += Imbalance[0][pt1index][pt2index] * pieceCounts[color][pt2index] + Imbalance[1][pt1index][pt2index] * pieceCounts[!color][pt2index];
-            }
-
-            // Multiply the value with the number of pieces of the current type
-            value += V(v * pieceCounts[color][pt1index], v * pieceCounts[color][pt1index]);
-
-        }
-
-    }
+    const int value = compute_imbalance(pieceCounts, color);
 
-    return value;
+    return V(value, value);
 
 }
 
@@ -1039,21 +1195,58 @@ static void init_eval_info(const Board& board, EvalInfo& info) {
 }
 
 // Evaluate the position statically
+int evaluate(const Board& board, Thread& thread) {
+
+    bool complete;
+
+    return evaluate(board, thread, -VALUE_INFINITE, VALUE_INFINITE, complete);
+
+}
+
+// Evaluate the position statically with the tables of a thread of the pool
 int evaluate(const Board& board, const unsigned threadIndex) {
 
-    Thread* thread = Threads.get_thread(threadIndex);
+    return evaluate(board, *Threads.get_thread(threadIndex));
+
+}
+
+int evaluate(const Board& board, const unsigned threadIndex, const Value alpha, const Value beta, bool& complete) {
+
+    return evaluate(board, *Threads.get_thread(threadIndex), alpha, beta, complete);
+
+}
+
+// Evaluate the position statically in two stages. The first stage consists of the cheap terms:
+// material, piece square tables, pawn structure and imbalances, which mostly come from hash tables.
+// If this partial evaluation is outside of the [alpha, beta] window by more than LazyMargin, the
+// remaining terms are very unlikely to bring it back into the window. In that case the partial
+// evaluation is returned and complete is set to false
+int evaluate(const Board& board, Thread& thread, const Value alpha, const Value beta, bool& complete) {
 
     EvalTerm value;
     EvalInfo info;
     int phase;
 
+    complete = true;
+
     // Check for draw by insufficient material
     if (board.is_material_draw()) {
         return 0;
     }
 
+    // Use the neural network instead of the handcrafted evaluation if it is enabled
+    if (NNUE::is_enabled()) {
+        return NNUE::evaluate(board);
+    }
+
+    // Probe the evaluation cache. It only holds complete evaluations, so a hit can be returned directly
+    EvalEntry * eentry = thread.evalCache.probe(board.hashkey());
+    if (eentry != NULL) {
+        return eentry->value;
+    }
+
     // Probe the pawn hash table
-    PawnEntry * pentry = thread->pawnTable.probe(board.pawnkey());
+    PawnEntry * pentry = thread.pawnTable.probe(board.pawnkey());
     if (pentry != NULL) {
         value += pentry->value;
         info.passedPawns = pentry->passedPawns;
@@ -1068,9 +1261,6 @@ int evaluate(const Board& board, const unsigned threadIndex) {
         info.pieceAttacks[BLACK][PAWN] = board.gen_black_pawns_attacks();
     }
 
-    // Initialize the evaluation
-    init_eval_info(board, info);
-
     // Material balance
     value += board.material(WHITE);
     value -= board.material(BLACK);
@@ -1082,10 +1272,41 @@ int evaluate(const Board& board, const unsigned threadIndex) {
     // Pawns Evaluation (skip if we already have a value from the hash table)
     if (pentry == NULL) {
         EvalTerm pawnValue = evaluate_pawns(board, WHITE, info) - evaluate_pawns(board, BLACK, info);
-        thread->pawnTable.store(board.pawnkey(), pawnValue, info.pieceAttacks[WHITE][PAWN], info.pieceAttacks[BLACK][PAWN], info.passedPawns, info.pawnAttacksSpan[WHITE], info.pawnAttacksSpan[BLACK]);
+        thread.pawnTable.store(board.pawnkey(), pawnValue, info.pieceAttacks[WHITE][PAWN], info.pieceAttacks[BLACK][PAWN], info.passedPawns, info.pawnAttacksSpan[WHITE], info.pawnAttacksSpan[BLACK]);
         value += pawnValue;
     }
 
+    // Imbalances and game phase from the material table
+    const unsigned whiteMaterial = material_index(board, WHITE);
+    const unsigned blackMaterial = material_index(board, BLACK);
+    if (whiteMaterial < MaterialSideCount && blackMaterial < MaterialSideCount) {
+        const int imbalance = MaterialImbalance[whiteMaterial][blackMaterial];
+        phase = MaterialPhase[whiteMaterial % NonPawnSideCount][blackMaterial % NonPawnSideCount];
+        value += V(imbalance, imbalance);
+        assert(V(imbalance, imbalance) == (evaluate_imbalances(board, WHITE) - evaluate_imbalances(board, BLACK)));
+        assert(phase == compute_phase(board));
+    } else {
+        phase = compute_phase(board);
+        value += evaluate_imbalances(board, WHITE) - evaluate_imbalances(board, BLACK);
+    }
+
+    // Lazy Evaluation
+    // Return the partial evaluation if it is far enough outside of the window
+    if (alpha > -VALUE_INFINITE || beta < VALUE_INFINITE) {
+
+        const int scaledEval = scale_evaluation(board, phase, value);
+        const int lazyEval   = ((board.turn() == WHITE) ? scaledEval : -scaledEval) + tempoBonus;
+
+        if (lazyEval - LazyMargin >= beta || lazyEval + LazyMargin <= alpha) {
+            complete = false;
+            return lazyEval;
+        }
+
+    }
+
+    // Initialize the evaluation
+    init_eval_info(board, info);
+
     // Evaluate the pieces
     value += evaluate_knights(board, WHITE, info);
     value += evaluate_bishops(board, WHITE, info);
@@ -1113,27 +1334,18 @@ int evaluate(const Board& board, const unsigned threadIndex) {
     value += evaluate_threats(board, WHITE, info);
     value -= evaluate_threats(board, BLACK, info);
 
-    // Imbalances
-    MaterialEntry * mentry = thread->materialTable.probe(board.materialkey());
-    if (mentry != NULL) {
-        phase = mentry->phase;
-        value += mentry->value;
-        assert(mentry->value == (evaluate_imbalances(board, WHITE) - evaluate_imbalances(board, BLACK)));
-    } else {
-        phase = compute_phase(board);
-        EvalTerm imbalanceValue = evaluate_imbalances(board, WHITE) - evaluate_imbalances(board, BLACK);
-        thread->materialTable.store(board.materialkey(), phase, imbalanceValue);
-        value += imbalanceValue;
-    }
-
     int scaledEval = scale_evaluation(board, phase, value);
 
     assert(std::abs(scaledEval) < VALUE_MATE_MAX);
 
     // Return the scaled evaluation and add a tempo bonus for the color to move
     // Also, invert the evaluation to match the perspective of the color to move
-    return ((board.turn() == WHITE) ?  scaledEval
-                                    : -scaledEval) + tempoBonus;
+    const int eval = ((board.turn() == WHITE) ?  scaledEval
+                                              : -scaledEval) + tempoBonus;
+
+    thread.evalCache.store(board.hashkey(), eval);
+
+    return eval;
 
 }
 
@@ -1141,6 +1353,12 @@ int evaluate(const Board& board, const unsigned threadIndex) {
 // all evaluation terms to the console. Useful for debugging
 void evaluate_info(const Board& board) {
 
+    // The neural network has no separate terms
+    if (NNUE::is_enabled()) {
+        std::cout << "NNUE evaluation (side to move): " << NNUE::evaluate(board) << std::endl;
+        return;
+    }
+
     EvalTerm value;
 
     EvalInfo info;
@@ -1187,32 +1405,32 @@ void evaluate_info(const Board& board) {
 
     // Output evaluation terms to the console
     std::cout << "(White)" << std::endl;
-    std::cout << "Material & Psqt : " << whiteMaterialPsqt.mg << " | " << whiteMaterialPsqt.eg << std::endl;
-    std::cout << "Imbalance       : " << whiteImbalances.mg << " | " << whiteImbalances.eg << std::endl;
-    std::cout << "Pawns           : " << whitePawns.mg << " | " << whitePawns.eg << std::endl;
-    std::cout << "Knights         : " << whiteKnights.mg << " | " << whiteKnights.eg << std::endl;
-    std::cout << "Bishops         : " << whiteBishops.mg << " | " << whiteBishops.eg << std::endl;
-    std::cout << "Rooks           : " << whiteRooks.mg << " | " << whiteRooks.eg << std::endl;
-    std::cout << "Queens          : " << whiteQueens.mg << " | " << whiteQueens.eg << std::endl;
-    std::cout << "Mobility        : " << info.mobility[WHITE].mg << " | " << info.mobility[WHITE].eg << std::endl;
-    std::cout << "Passed Pawns    : " << whitePassers.mg << " | " << whitePassers.eg << std::endl;
-    std::cout << "King safety     : " << whiteKingSafety.mg << " | " << whiteKingSafety.eg << std::endl;
-    std::cout << "Threats         : " << whiteThreats.mg << " | " << whiteThreats.eg << std::endl;
+    std::cout << "Material & Psqt : " << whiteMaterialPsqt.mg() << " | " << whiteMaterialPsqt.eg() << std::endl;
+    std::cout << "Imbalance       : " << whiteImbalances.mg() << " | " << whiteImbalances.eg() << std::endl;
+    std::cout << "Pawns           : " << whitePawns.mg() << " | " << whitePawns.eg() << std::endl;
+    std::cout << "Knights         : " << whiteKnights.mg() << " | " << whiteKnights.eg() << std::endl;
+    std::cout << "Bishops         : " << whiteBishops.mg() << " | " << whiteBishops.eg() << std::endl;
+    std::cout << "Rooks           : " << whiteRooks.mg() << " | " << whiteRooks.eg() << std::endl;
+    std::cout << "Queens          : " << whiteQueens.mg() << " | " << whiteQueens.eg() << std::endl;
+    std::cout << "Mobility        : " << info.mobility[WHITE].mg() << " | " << info.mobility[WHITE].eg() << std::endl;
+    std::cout << "Passed Pawns    : " << whitePassers.mg() << " | " << whitePassers.eg() << std::endl;
+    std::cout << "King safety     : " << whiteKingSafety.mg() << " | " << whiteKingSafety.eg() << std::endl;
+    std::cout << "Threats         : " << whiteThreats.mg() << " | " << whiteThreats.eg() << std::endl;
 
     std::cout << std::endl;
 
     std::cout << "(Black)" << std::endl;
-    std::cout << "Material & Psqt : " << blackMaterialPsqt.mg << " | " << blackMaterialPsqt.eg << std::endl;
-    std::cout << "Imbalance       : " << blackImbalances.mg << " | " << blackImbalances.eg << std::endl;
-    std::cout << "Pawns           : " << blackPawns.mg << " | " << blackPawns.eg << std::endl;
-    std::cout << "Knights         : " << blackKnights.mg << " | " << blackKnights.eg << std::endl;
-    std::cout << "Bishops         : " << blackBishops.mg << " | " << blackBishops.eg << std::endl;
-    std::cout << "Rooks           : " << blackRooks.mg << " | " << blackRooks.eg << std::endl;
-    std::cout << "Queens          : " << blackQueens.mg << " | " << blackQueens.eg << std::endl;
-    std::cout << "Mobility        : " << info.mobility[BLACK].mg << " | " << info.mobility[BLACK].eg << std::endl;
-    std::cout << "Passed Pawns    : " << blackPassers.mg << " | " << blackPassers.eg << std::endl;
-    std::cout << "King safety     : " << blackKingSafety.mg << " | " << blackKingSafety.eg << std::endl;
-    std::cout << "Threats         : " << blackThreats.mg << " | " << blackThreats.eg << std::endl;
+    std::cout << "Material & Psqt : " << blackMaterialPsqt.mg() << " | " << blackMaterialPsqt.eg() << std::endl;
+    std::cout << "Imbalance       : " << blackImbalances.mg() << " | " << blackImbalances.eg() << std::endl;
+    std::cout << "Pawns           : " << blackPawns.mg() << " | " << blackPawns.eg() << std::endl;
+    std::cout << "Knights         : " << blackKnights.mg() << " | " << blackKnights.eg() << std::endl;
+    std::cout << "Bishops         : " << blackBishops.mg() << " | " << blackBishops.eg() << std::endl;
+    std::cout << "Rooks           : " << blackRooks.mg() << " | " << blackRooks.eg() << std::endl;
+    std::cout << "Queens          : " << blackQueens.mg() << " | " << blackQueens.eg() << std::endl;
+    std::cout << "Mobility        : " << info.mobility[BLACK].mg() << " | " << info.mobility[BLACK].eg() << std::endl;
+    std::cout << "Passed Pawns    : " << blackPassers.mg() << " | " << blackPassers.eg() << std::endl;
+    std::cout << "King safety     : " << blackKingSafety.mg() << " | " << blackKingSafety.eg() << std::endl;
+    std::cout << "Threats         : " << blackThreats.mg() << " | " << blackThreats.eg() << std::endl;
 
     std::cout << std::endl;
 
@@ -1246,3 +1464,106 @@ void evaluate_info(const Board& board) {
     std::cout << "Total(For White): " << scaledEval << std::endl;
 
 }
+
+#ifdef EVAL_TUNE
+namespace Eval {
+
+    // Evaluate the position like evaluate() does without using any hash tables and record
+    // the linearized evaluation in the trace. Returns false if the position is not evaluated
+    // by the handcrafted terms
+    bool trace(const Board& board, EvalTrace& trace) {
+
+        if (board.is_material_draw()) {
+            return false;
+        }
+
+        trace = EvalTrace();
+        Trace = &trace;
+
+        EvalTerm value;
+        EvalInfo info;
+
+        // Material and piece square tables
+        for (Color color = WHITE; color <= BLACK; ++color) {
+            for (Piecetype pt = PAWN; pt <= KING; ++pt) {
+                Bitboard pieces = board.pieces(color, pt);
+                while (pieces) {
+                    const Square sq = pop_lsb(pieces);
+                    const unsigned r = color == WHITE ? sq / 8 : 7 - sq / 8;
+                    const unsigned f = std::min(sq % 8, 7 - sq % 8);
+                    trace.terms[color][TUNE_PST + pt * 32 + 4 * r + f]++;
+                    if (pt != KING) {
+                        trace.terms[color][TUNE_MATERIAL + pt]++;
+                    }
+                }
+            }
+        }
+
+        value += board.material(WHITE) + board.pst(WHITE);
+        value -= board.material(BLACK) + board.pst(BLACK);
+
+        info.pieceAttacks[WHITE][PAWN] = board.gen_white_pawns_attacks();
+        info.pieceAttacks[BLACK][PAWN] = board.gen_black_pawns_attacks();
+
+        value += evaluate_pawns(board, WHITE, info) - evaluate_pawns(board, BLACK, info);
+        value += evaluate_imbalances(board, WHITE) - evaluate_imbalances(board, BLACK);
+
+        init_eval_info(board, info);
+
+        value += evaluate_knights(board, WHITE, info) + evaluate_bishops(board, WHITE, info) + evaluate_rooks(board, WHITE, info) + evaluate_queens(board, WHITE, info);
+        value -= evaluate_knights(board, BLACK, info) + evaluate_bishops(board, BLACK, info) + evaluate_rooks(board, BLACK, info) + evaluate_queens(board, BLACK, info);
+
+        value += info.mobility[WHITE] - info.mobility[BLACK];
+        value += evaluate_king_safety(board, WHITE, info) - evaluate_king_safety(board, BLACK, info);
+        value += evaluate_passers(board, WHITE, info) - evaluate_passers(board, BLACK, info);
+        value += evaluate_threats(board, WHITE, info) - evaluate_threats(board, BLACK, info);
+
+        trace.value       = value;
+        trace.phase       = compute_phase(board);
+        trace.scaleFactor = compute_scale_factor(board, value);
+
+        Trace = nullptr;
+
+        return true;
+
+    }
+
+    // Current values of the tunable terms and king danger weights
+    void tune_parameters(EvalTerm terms[TUNE_TERM_COUNT], int weights[DANGER_WEIGHT_COUNT]) {
+
+        for (Piecetype pt = PAWN; pt < KING; ++pt) {
+            terms[TUNE_MATERIAL + pt] = Material[pt];
+        }
+
+        for (Piecetype pt = PAWN; pt <= KING; ++pt) {
+            for (unsigned sq = 0; sq < 32; sq++) {
+                terms[TUNE_PST + pt * 32 + sq] = PstValues[pt][sq];
+            }
+        }
+
+        for (unsigned type = 0; type < 4; type++) {
+            for (unsigned mobility = 0; mobility < 28; mobility++) {
+                terms[TUNE_MOBILITY + type * 28 + mobility] = Mobility[type][mobility];
+            }
+        }
+
+        weights[DANGER_NO_QUEEN]        = kingNoQueenAttacker;
+        weights[DANGER_QUEEN_CHECK]     = queenSafeCheckWeight;
+        weights[DANGER_ROOK_CHECK]      = rookSafeCheckWeight;
+        weights[DANGER_BISHOP_CHECK]    = bishopSafeCheckWeight;
+        weights[DANGER_KNIGHT_CHECK]    = knightSafeCheckWeight;
+        weights[DANGER_UNSAFE_CHECK]    = kingUnsafeCheck;
+        weights[DANGER_RING_ATTACK]     = kingRingAttackWeight;
+        weights[DANGER_WEAK_SQUARE]     = kingRingWeakSquareAttack;
+        weights[DANGER_SLIDER_BLOCKER]  = kingSliderBlocker;
+        weights[DANGER_KNIGHT_DEFENDER] = kingKnightDefender;
+        weights[DANGER_BISHOP_DEFENDER] = kingBishopDefender;
+
+        for (Piecetype pt = KNIGHT; pt <= QUEEN; ++pt) {
+            weights[DANGER_ATTACKER + pt - KNIGHT] = attackerWeight[pt];
+        }
+
+    }
+
+}
+#endif
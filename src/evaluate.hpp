@@ -30,8 +30,10 @@
 #include "move.hpp"
 #include <complex> // for std::abs
 
+class Thread;
+
 // Material values of pieces
-static const EvalTerm Material[6] = {
+static constexpr EvalTerm Material[6] = {
 
     V(  60,  100),
     V( 365,  405),
@@ -75,11 +77,59 @@ struct EvalInfo {
 
 extern EvalTerm PieceSquareTable[2][6][64];
 
+#ifdef EVAL_TUNE
+
+// Offsets of the tunable terms with a midgame and an endgame value (make TUNE=yes)
+enum TuneTerm : unsigned {
+
+    TUNE_MATERIAL   = 0, // Pawn to queen
+    TUNE_PST        = TUNE_MATERIAL + 5, // [piece type][mirrored square]
+    TUNE_MOBILITY   = TUNE_PST + 6 * 32, // [piece type - KNIGHT][mobility]
+    TUNE_TERM_COUNT = TUNE_MOBILITY + 4 * 28
+
+};
+
+// The tunable king danger weights
+enum TuneDangerWeight : unsigned {
+
+    DANGER_NO_QUEEN, DANGER_QUEEN_CHECK, DANGER_ROOK_CHECK, DANGER_BISHOP_CHECK, DANGER_KNIGHT_CHECK,
+    DANGER_UNSAFE_CHECK, DANGER_RING_ATTACK, DANGER_WEAK_SQUARE, DANGER_SLIDER_BLOCKER,
+    DANGER_KNIGHT_DEFENDER, DANGER_BISHOP_DEFENDER,
+    DANGER_ATTACKER, // [piece type - KNIGHT]
+    DANGER_WEIGHT_COUNT = DANGER_ATTACKER + 4
+
+};
+
+// Linearized evaluation of a position. The evaluation is linear in the tunable terms,
+// the king safety of each color depends on its king danger, which is linear in the
+// danger weights. Everything else is recorded as a constant
+struct EvalTrace {
+
+    int8_t terms[2][TUNE_TERM_COUNT]; // How often each term counts for each color
+    int16_t danger[2][DANGER_WEIGHT_COUNT]; // How often each weight adds to the king danger of each color
+    uint8_t kingAttackers[2][6]; // Pieces of each type attacking the king ring of each color
+    int kingDanger[2];
+    EvalTerm kingSafety[2]; // King safety before limiting the midgame value
+    EvalTerm value; // Complete evaluation from white's point of view before scaling
+    int phase;
+    int scaleFactor;
+
+};
+
+#endif
+
+extern int evaluate(const Board& board, Thread& thread);
+extern int evaluate(const Board& board, Thread& thread, const Value alpha, const Value beta, bool& complete);
 extern int evaluate(const Board& board, const unsigned threadIndex);
+extern int evaluate(const Board& board, const unsigned threadIndex, const Value alpha, const Value beta, bool& complete);
 extern void evaluate_info(const Board& board);
 
 namespace Eval {
     extern void init();
+#ifdef EVAL_TUNE
+    extern bool trace(const Board& board, EvalTrace& trace);
+    extern void tune_parameters(EvalTerm terms[TUNE_TERM_COUNT], int weights[DANGER_WEIGHT_COUNT]);
+#endif
 }
 
 #endif
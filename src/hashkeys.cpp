@@ -28,7 +28,6 @@
 // Hashkey arrays for generating a position hashkey
 uint64_t PieceHashKeys[2][7][64];
 uint64_t PawnHashKeys[2][64];
-uint64_t MaterialHashKeys[2][6][11];
 uint64_t TurnHashKeys[2];
 uint64_t CastlingHashKeys[16];
 uint64_t EnPassantHashKeys[8];
@@ -51,7 +50,6 @@ namespace Hash {
     // Initialize the hash keys
     // For each color, we assign a hashkey to each square for each piece type
     // Also, we assign hashkeys to a second array for each pawn of both colors for each square
-    // We also have hashkeys for all possible configurations of material on the board
     // There are also hashkeys for all possible castling states and 8 hashkeys for each file where
     // there could be a potential en-passant square.
     // Furthermore, there are two additional hashkeys representing the current color to move
@@ -64,11 +62,6 @@ namespace Hash {
                 }
                 PawnHashKeys[c][sq] = rand64();
             }
-            for (Piecetype pt = PAWN; pt < PIECE_NONE; ++pt) {
-                for (unsigned i = 0; i < 11; i++) {
-                    MaterialHashKeys[c][pt][i] = rand64();
-                }
-            }
         }
 
         for (unsigned i = 0; i < 16; i++) {
@@ -205,30 +198,60 @@ unsigned TranspositionTable::hashfull() {
 
 }
 
-// Clears the material hash table
-void MaterialTable::clear() {
+// Resizes the evaluation cache. The number of entries is rounded down to a power of two,
+// so that an entry can be indexed by masking the hash key
+void EvalCache::set_size(const unsigned megabytes) {
 
-    std::memset(table, 0, sizeof(MaterialEntry) * size);
+    delete[] table;
 
-}
+    size = 1;
+    while (size * 2 <= MB * megabytes / sizeof(EvalEntry)) {
+        size *= 2;
+    }
 
-// Probes the material hash table and returns the corresponding entry
-MaterialEntry * MaterialTable::probe(const uint64_t key) {
+    try {
+        table = new EvalEntry [size];
+    } catch (std::bad_alloc& exception) {
+        std::cerr << "Error: Failed to allocate memory of size "
+                << megabytes
+                << " megabytes for Evaluation Cache." << std::endl
+                << "OS message: " << exception.what();
+        std::exit(EXIT_FAILURE);
+    }
 
-    MaterialEntry * entry = &(table[key % size]);
+    clear();
 
-    if (entry->key == key) {
-        return entry;
-    }
+}
 
-    return NULL;
+// Clears the evaluation cache
+void EvalCache::clear() {
+
+    std::memset(table, 0, sizeof(EvalEntry) * size);
 
 }
 
-// Stores a material imbalance evaluation in the material hash table given the masterial hash key
-void MaterialTable::store(const uint64_t key, const int phase, const EvalTerm value) {
+// Resizes the pawn hash table. The number of entries is rounded down to a power of two,
+// so that an entry can be indexed by masking the pawn hash key
+void PawnTable::set_size(const unsigned megabytes) {
+
+    delete[] table;
+
+    size = 1;
+    while (size * 2 <= MB * megabytes / sizeof(PawnEntry)) {
+        size *= 2;
+    }
+
+    try {
+        table = new PawnEntry [size];
+    } catch (std::bad_alloc& exception) {
+        std::cerr << "Error: Failed to allocate memory of size "
+                << megabytes
+                << " megabytes for Pawn Hash Table." << std::endl
+                << "OS message: " << exception.what();
+        std::exit(EXIT_FAILURE);
+    }
 
-    table[key % size] = { key, phase, value };
+    clear();
 
 }
 
@@ -242,9 +265,16 @@ void PawnTable::clear() {
 // Probes the pawn hash table and returns the corresponding entry
 PawnEntry * PawnTable::probe(const uint64_t key) {
 
-    PawnEntry * entry = &(table[key % size]);
+    PawnEntry * entry = &(table[key & (size - 1)]);
+
+#ifdef SEARCH_STATS
+    probes++;
+#endif
 
     if (entry->key == key) {
+#ifdef SEARCH_STATS
+        hits++;
+#endif
         return entry;
     }
 
@@ -255,6 +285,6 @@ PawnEntry * PawnTable::probe(const uint64_t key) {
 // Stores a pawn structure evaluation value and several pawn related bitboards for a given pawn hash key
 void PawnTable::store(const uint64_t key, const EvalTerm value, const uint64_t pawnWAttacks, const uint64_t pawnBAttacks, const uint64_t passedPawns, const uint64_t pawnWAttacksSpan, const uint64_t pawnBAttacksSpan) {
 
-    table[key % size] = { key, value, pawnWAttacks, pawnBAttacks, passedPawns, pawnWAttacksSpan, pawnBAttacksSpan };
+    table[key & (size - 1)] = { key, value, pawnWAttacks, pawnBAttacks, passedPawns, pawnWAttacksSpan, pawnBAttacksSpan };
 
 }
\ No newline at end of file
@@ -78,7 +78,8 @@ struct TTEntry {
 
 };
 
-struct PawnEntry {
+// Aligned to a cache line, so that a probe never has to touch two of them
+struct alignas(64) PawnEntry {
 
     uint64_t key;
     EvalTerm value;
@@ -90,11 +91,10 @@ struct PawnEntry {
 
 };
 
-struct MaterialEntry {
+struct EvalEntry {
 
     uint64_t key;
-    int phase;
-    EvalTerm value;
+    int value;
 
 };
 
@@ -132,17 +132,22 @@ class PawnTable {
 
     public:
 
-        unsigned size = 0x10000;
+        unsigned size = 0;
+
+        PawnEntry *table = nullptr;
 
-        PawnEntry *table;
+#ifdef SEARCH_STATS
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+#endif
 
+        void set_size(const unsigned megabytes);
         void clear();
         PawnEntry * probe(const uint64_t key);
         void store(const uint64_t key, const EvalTerm value, const uint64_t pawnWAttacks, const uint64_t pawnBAttacks, const uint64_t passedPawns, const uint64_t pawnWAttacksSpan, const uint64_t pawnBAttacksSpan);
 
         PawnTable() {
-            table = new PawnEntry [size];
-            clear();
+            set_size(4);
         }
 
         ~PawnTable() {
@@ -151,24 +156,46 @@ class PawnTable {
 
 };
 
-class MaterialTable {
+// Direct-mapped cache of complete static evaluations, indexed by the position hash key
+class EvalCache {
 
     public:
 
-        unsigned size = 0x2000;
+        unsigned size = 0;
 
-        MaterialEntry *table;
+        EvalEntry *table = nullptr;
 
+#ifdef SEARCH_STATS
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+#endif
+
+        void set_size(const unsigned megabytes);
         void clear();
-        MaterialEntry * probe(const uint64_t key);
-        void store(const uint64_t key, const int phase, const EvalTerm value);
 
-        MaterialTable() {
-            table = new MaterialEntry [size];
-            clear();
+        EvalEntry * probe(const uint64_t key) {
+#ifdef SEARCH_STATS
+            probes++;
+#endif
+            EvalEntry * entry = &(table[key & (size - 1)]);
+            if (entry->key == key) {
+#ifdef SEARCH_STATS
+                hits++;
+#endif
+                return entry;
+            }
+            return NULL;
+        }
+
+        void store(const uint64_t key, const int value) {
+            table[key & (size - 1)] = { key, value };
+        }
+
+        EvalCache() {
+            set_size(1);
         }
 
-        ~MaterialTable() {
+        ~EvalCache() {
             delete[] table;
         }
 
@@ -199,7 +226,6 @@ inline int value_from_tt(Value value, Depth plies) {
 
 extern uint64_t PieceHashKeys[2][7][64];
 extern uint64_t PawnHashKeys[2][64];
-extern uint64_t MaterialHashKeys[2][6][11];
 extern uint64_t TurnHashKeys[2];
 extern uint64_t CastlingHashKeys[16];
 extern uint64_t EnPassantHashKeys[8];
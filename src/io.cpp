@@ -0,0 +1,211 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "io.hpp"
+
+namespace IO {
+
+    static OutputQueue Queue;
+    static std::ostream* Stream = &std::cout;
+    static std::thread Writer;
+    static std::atomic_bool Running{false};
+
+    // The writer sleeps when the queue is empty. Producers only take the mutex to wake it up
+    static std::mutex Mutex;
+    static std::condition_variable WakeUp;
+    static std::condition_variable Flushed;
+    static std::atomic_bool Sleeping{false};
+    static bool ShouldExit = false;
+
+    static std::atomic<uint64_t> QueuedCount{0};
+    static uint64_t WrittenCount = 0; // Only accessed by the writer
+    static uint64_t FlushedCount = 0; // Protected by the mutex
+
+    OutputQueue::~OutputQueue() {
+
+        while (Message* message = pop()) {
+            delete message;
+        }
+
+    }
+
+    void OutputQueue::push(Message* message) {
+
+        message->next.store(nullptr, std::memory_order_relaxed);
+        Message* previous = head.exchange(message, std::memory_order_acq_rel);
+        previous->next.store(message, std::memory_order_release);
+
+    }
+
+    // Take the oldest message from the queue. Returns nullptr if the queue is empty or a
+    // producer has not linked its message yet; in that case the message is found on a later call
+    Message* OutputQueue::pop() {
+
+        Message* last = tail;
+        Message* next = last->next.load(std::memory_order_acquire);
+
+        // Skip the stub, which is never handed out
+        if (last == &stub) {
+            if (!next) {
+                return nullptr;
+            }
+            tail = last = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next) {
+            tail = next;
+            return last;
+        }
+
+        if (last != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        // The last message can only be handed out with the stub queued behind it
+        push(&stub);
+
+        next = last->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return last;
+        }
+
+        return nullptr;
+
+    }
+
+    // Write queued lines until the writer is stopped. The stream is only flushed when the queue is empty
+    static void write_lines() {
+
+        while (true) {
+
+            while (Message* message = Queue.pop()) {
+                *Stream << message->text << '\n';
+                delete message;
+                WrittenCount++;
+            }
+
+            Stream->flush();
+
+            std::unique_lock<std::mutex> lock(Mutex);
+
+            if (QueuedCount != WrittenCount) {
+                // A producer is still linking its message
+                lock.unlock();
+                std::this_thread::yield();
+                continue;
+            }
+
+            FlushedCount = WrittenCount;
+            Flushed.notify_all();
+
+            if (ShouldExit) {
+                return;
+            }
+
+            Sleeping = true;
+            WakeUp.wait(lock, [] { return QueuedCount != WrittenCount || ShouldExit; });
+            Sleeping = false;
+
+        }
+
+    }
+
+    // Start the writer thread, which writes all further lines to the given stream
+    void start(std::ostream& stream) {
+
+        if (Running) {
+            return;
+        }
+
+        Stream = &stream;
+        ShouldExit = false;
+        Running = true;
+        Writer = std::thread(write_lines);
+
+    }
+
+    // Write all queued lines and stop the writer thread
+    void stop() {
+
+        if (!Running) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            ShouldExit = true;
+        }
+
+        WakeUp.notify_one();
+        Writer.join();
+
+        Running = false;
+        Stream = &std::cout;
+
+    }
+
+    // Send a line. Never waits for the stream if the writer thread is running
+    void send(std::string line) {
+
+        if (!Running) {
+            *Stream << line << std::endl;
+            return;
+        }
+
+        Message* message = new Message();
+        message->text = std::move(line);
+
+        Queue.push(message);
+        QueuedCount++;
+
+        if (Sleeping) {
+            std::lock_guard<std::mutex> lock(Mutex);
+            WakeUp.notify_one();
+        }
+
+    }
+
+    // Wait until all lines sent so far have been written and flushed. Used before
+    // output which does not go through the queue
+    void flush() {
+
+        if (!Running) {
+            std::cout.flush();
+            return;
+        }
+
+        const uint64_t target = QueuedCount;
+
+        std::unique_lock<std::mutex> lock(Mutex);
+        Flushed.wait(lock, [target] { return FlushedCount >= target; });
+
+    }
+
+}
@@ -0,0 +1,73 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#ifndef IO_H
+#define IO_H
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+// Output of the UCI loop. Lines are passed through a lock-free queue to a dedicated writer
+// thread, so that searching threads never wait for a slow pipe. Without the writer thread,
+// lines are written directly
+
+namespace IO {
+
+    // Line in the output queue
+    struct Message {
+        std::atomic<Message*> next{nullptr};
+        std::string text;
+    };
+
+    // Intrusive queue with multiple producers and a single consumer. Producers only
+    // exchange the head pointer, the consumer follows the links from the tail
+    class OutputQueue {
+
+        public:
+
+            OutputQueue() : head(&stub), tail(&stub) {}
+            OutputQueue(const OutputQueue&) = delete;
+            OutputQueue& operator=(const OutputQueue&) = delete;
+            ~OutputQueue();
+
+            void push(Message* message);
+            Message* pop();
+
+        private:
+
+            std::atomic<Message*> head;
+            Message* tail;
+            Message stub;
+
+    };
+
+    extern void start(std::ostream& stream = std::cout);
+    extern void stop();
+    extern void send(std::string line);
+    extern void flush();
+
+}
+
+#endif
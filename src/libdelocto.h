@@ -0,0 +1,90 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+
+#ifndef LIBDELOCTO_H
+#define LIBDELOCTO_H
+
+/* C interface of the engine library, built with make library. Every engine instance
+   searches on its own thread, several instances can search at the same time */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DELOCTO_PV_MAX 64
+
+typedef struct DeloctoEngine DeloctoEngine;
+
+/* Limits of a search, zero means no limit. A search without limits runs until it is stopped */
+typedef struct DeloctoLimits {
+    int depth;
+    uint64_t nodes;
+    int64_t moveTime; /* Milliseconds */
+} DeloctoLimits;
+
+/* Result of the last completed iteration of a search */
+typedef struct DeloctoResult {
+    char bestMove[6]; /* UCI notation, empty if the position has no legal moves */
+    int isMate; /* Set if the score is a mate score */
+    int score; /* Centipawns, or moves until mate if isMate is set, from the point of view of the side to move */
+    int depth;
+    uint64_t nodes;
+    int pvLength;
+    char pv[DELOCTO_PV_MAX][6]; /* Principal variation in UCI notation */
+} DeloctoResult;
+
+typedef void (*DeloctoCallback)(const DeloctoResult* result, void* userData);
+
+/* Initialize the engine tables once per process before creating any instance */
+void delocto_init(void);
+
+/* Resize the shared transposition table, no instance may be searching */
+void delocto_set_hash_size(unsigned megabytes);
+
+DeloctoEngine* delocto_engine_new(void);
+void delocto_engine_free(DeloctoEngine* engine);
+
+/* Set the position to search, returns 0 if the position is invalid and keeps the previous one.
+   A packed position is a 32 byte record of a dataset file */
+int delocto_set_fen(DeloctoEngine* engine, const char* fen);
+int delocto_set_packed(DeloctoEngine* engine, const void* position);
+
+/* Start a search and return immediately. The callback is called with the result on the search
+   thread of the instance when the search has finished, it must not start another search of
+   the same instance. A search which is still running is waited for first */
+void delocto_search(DeloctoEngine* engine, const DeloctoLimits* limits, DeloctoCallback callback, void* userData);
+
+/* Stop the running search of the instance, the callback is called as usual */
+void delocto_stop(DeloctoEngine* engine);
+
+/* Wait until the running search of the instance and its callback have finished */
+void delocto_wait(DeloctoEngine* engine);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -56,6 +56,10 @@ bool Board::is_legal(const Move move) const {
     // We remove the king since the king might block the attack of an enemy slider
     // to the square
     if (fromSq == kSq) {
+        // Without a check, no slider attacks through the king square, so the attack map is enough
+        if (has_attack_map() && !checkers()) {
+            return !sq_attacked(toSq, !stm);
+        }
         return !sq_attacked_noking(toSq, !stm);
     } else if (checkers()) {
         // If there is more than one checker and we are not moving the king,
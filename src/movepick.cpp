@@ -23,20 +23,46 @@
 
 #include "movepick.hpp"
 
-// Score all the moves with the Most Valuable Victim - Least Valuable Attacker Heuristic
+// Score of a quiet move: the sum of its history and its continuation history scores
+// for the moves played one and two plies ago
+inline int MovePicker::quiet_score(const Move move) const {
+
+    const Color color = board.turn();
+    const Piecetype pt = board.piecetype(from_sq(move));
+    const Square toSq = to_sq(move);
+
+    return history->get_score(color, pt, toSq)
+         + continuationHistory[0]->get_score(color, pt, toSq)
+         + continuationHistory[1]->get_score(color, pt, toSq);
+
+}
+
+// Score of a capture: the Most Valuable Victim - Least Valuable Attacker value, refined by
+// the capture history. The history term is small enough to only reorder captures of the same
+// victim, and the score never becomes negative
+inline int MovePicker::capture_score(const Move move) const {
+
+    const Square toSq = to_sq(move);
+    const Piecetype captured = is_ep(move) ? PAWN : board.piecetype(toSq);
+
+    return 32 * board.mvvlva(move) + captureHistory->get_score(board.turn(), board.piecetype(from_sq(move)), toSq, captured) / 64;
+
+}
+
+// Score all the captures
 void MovePicker::score_captures() {
 
     for (unsigned index = 0; index < moves.size(); index++) {
-        moves.set_score(index, board.mvvlva(moves[index]));
+        moves.set_score(index, capture_score(moves[index]));
     }
 
 }
 
-// Assign each move a score from the history table
+// Assign each move a score from the history tables
 void MovePicker::score_quiets() {
 
     for (unsigned index = 0; index < moves.size(); index++) {
-        moves.set_score(index, history->get_score(board.turn(), board.piecetype(from_sq(moves[index])), to_sq(moves[index])));
+        moves.set_score(index, quiet_score(moves[index]));
     }
 
 }
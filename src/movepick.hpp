@@ -93,20 +93,21 @@ class MovePicker {
     public:
 
         const Board& board;
-        const SearchInfo *info;
 
         Move counterMove = MOVE_NONE;
 
         // Constructor for normal search
-        MovePicker(const Board& b, SearchInfo *i, const KillerMoves& k, const HistoryTable *h, const CounterMoveTable& c, Depth plies, Move t) : board(b), info(i), killers(std::make_pair(k.first(plies), k.second(plies))), history(h) {
+        MovePicker(const Board& b, const SearchStack *ss, const HistoryTable *h, const CaptureHistoryTable *ch, const CounterMoveTable& c, Move t)
+            : board(b), killers(std::make_pair(ss->killers[0], ss->killers[1])), history(h), captureHistory(ch),
+              continuationHistory{ (ss - 1)->continuationHistory, (ss - 2)->continuationHistory } {
 
             ttMove = t;
 
             phase = board.checkers() ? TT_MOVE_EVASIONS : TT_MOVE;
 
             // Get the counter move if available
-            if (plies > 0 && info->currentMove[plies-1] != MOVE_NONE) {
-                unsigned prevSq = to_sq(info->currentMove[plies-1]);
+            if ((ss - 1)->currentMove != MOVE_NONE) {
+                unsigned prevSq = to_sq((ss - 1)->currentMove);
                 counterMove = c.get_move(board.owner(prevSq), board.piecetype(prevSq), prevSq);
             }
 
@@ -118,11 +119,15 @@ class MovePicker {
         }
 
         // Constructor for quiescence search
-        MovePicker(const Board& b, SearchInfo * i, const HistoryTable *h, int plies, Move lastMove, Move t) : board(b), info(i), history(h) {
+        // Quiet moves are only scored in evasions here, which do not use the continuation history
+        MovePicker(const Board& b, const SearchStack *ss, const HistoryTable *h, const CaptureHistoryTable *ch, Move t)
+            : board(b), history(h), captureHistory(ch), continuationHistory{ nullptr, nullptr } {
+
+            const Move lastMove = (ss - 1)->currentMove;
 
             // Check if there is a transposition table move available
             // In quiescence search we only allow this move if it is a capture to the square of the last move
-            if (plies > 0 && lastMove != MOVE_NONE) {
+            if (lastMove != MOVE_NONE) {
                 ttMove = t != MOVE_NONE && (to_sq(lastMove) == to_sq(t)) ? t : MOVE_NONE;
             }
 
@@ -135,6 +140,9 @@ class MovePicker {
 
         }
 
+        int quiet_score(const Move move) const;
+        int capture_score(const Move move) const;
+
         void score_captures();
         void score_quiets();
         void score_evasions();
@@ -147,6 +155,8 @@ class MovePicker {
         Move ttMove = MOVE_NONE;
         const std::pair<Move, Move> killers;
         const HistoryTable *history;
+        const CaptureHistoryTable *captureHistory;
+        const PieceToHistory *continuationHistory[2]; // Continuation histories of the moves one and two plies ago
         ScoredMoveList moves;
         ScoredMoveList badCaptures;
 
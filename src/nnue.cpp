@@ -0,0 +1,324 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "nnue.hpp"
+#include "board.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace NNUE {
+
+    // A network file starts with this header, followed by the little-endian parameters:
+    // feature weights int16[InputSize][HiddenSize], feature biases int16[HiddenSize],
+    // output weights int16[2][HiddenSize] (side to move first) and the output bias int32
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t inputSize;
+        uint32_t hiddenSize;
+        char reserved[48];
+    };
+
+    static constexpr char     FileMagic[4] = { 'D', 'L', 'N', 'N' };
+    static constexpr uint32_t FileVersion  = 1;
+    static constexpr size_t   FileSize     = sizeof(FileHeader)
+                                           + sizeof(int16_t) * (InputSize * HiddenSize + HiddenSize + 2 * HiddenSize)
+                                           + sizeof(int32_t);
+
+    // Parameters of the loaded network. They point into the mapped network file
+    static const int16_t* featureWeights = nullptr;
+    static const int16_t* featureBiases  = nullptr;
+    static const int16_t* outputWeights  = nullptr;
+    static int32_t outputBias = 0;
+
+#ifndef _WIN32
+    static void* mapping = nullptr;
+#else
+    static std::vector<char> buffer;
+#endif
+
+    static bool enabled = false;
+
+    // Map a network file into memory and check its header. Returns false if the file
+    // cannot be read or does not contain a network of the expected architecture
+    bool load(const std::string& filename) {
+
+        unload();
+
+        const char* data;
+
+#ifndef _WIN32
+        const int fd = open(filename.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) == -1 || size_t(fileStat.st_size) != FileSize) {
+            close(fd);
+            return false;
+        }
+
+        void* address = mmap(nullptr, FileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (address == MAP_FAILED) {
+            return false;
+        }
+
+        mapping = address;
+        data = static_cast<const char*>(address);
+#else
+        std::ifstream file(filename, std::ios::binary | std::ios::ate);
+        if (!file || size_t(file.tellg()) != FileSize) {
+            return false;
+        }
+
+        buffer.resize(FileSize);
+        file.seekg(0);
+        file.read(buffer.data(), FileSize);
+        data = buffer.data();
+#endif
+
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(FileHeader));
+
+        if (   std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0
+            || header.version != FileVersion
+            || header.inputSize != InputSize
+            || header.hiddenSize != HiddenSize)
+        {
+            unload();
+            return false;
+        }
+
+        data += sizeof(FileHeader);
+        featureWeights = reinterpret_cast<const int16_t*>(data);
+        data += sizeof(int16_t) * InputSize * HiddenSize;
+        featureBiases  = reinterpret_cast<const int16_t*>(data);
+        data += sizeof(int16_t) * HiddenSize;
+        outputWeights  = reinterpret_cast<const int16_t*>(data);
+        data += sizeof(int16_t) * 2 * HiddenSize;
+        std::memcpy(&outputBias, data, sizeof(int32_t));
+
+        return true;
+
+    }
+
+    // Release the loaded network
+    void unload() {
+
+#ifndef _WIN32
+        if (mapping != nullptr) {
+            munmap(mapping, FileSize);
+            mapping = nullptr;
+        }
+#else
+        buffer.clear();
+#endif
+
+        featureWeights = featureBiases = outputWeights = nullptr;
+        outputBias = 0;
+
+    }
+
+    bool is_loaded() {
+
+        return featureWeights != nullptr;
+
+    }
+
+    bool is_enabled() {
+
+        return enabled && is_loaded();
+
+    }
+
+    void set_enabled(const bool e) {
+
+        enabled = e;
+
+    }
+
+    // Add the weights of the added inputs to the previous hidden values of one perspective and
+    // subtract the weights of the removed inputs
+    static void update_values(const int16_t* previous, int16_t* values, const unsigned* added, const unsigned addedCount, const unsigned* removed, const unsigned removedCount) {
+
+#if defined(__AVX2__)
+        for (unsigned i = 0; i < HiddenSize; i += 16) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous + i));
+            for (unsigned j = 0; j < addedCount; j++) {
+                v = _mm256_add_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(featureWeights + added[j] * HiddenSize + i)));
+            }
+            for (unsigned j = 0; j < removedCount; j++) {
+                v = _mm256_sub_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(featureWeights + removed[j] * HiddenSize + i)));
+            }
+            _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), v);
+        }
+#elif defined(__SSE4_1__)
+        for (unsigned i = 0; i < HiddenSize; i += 8) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i));
+            for (unsigned j = 0; j < addedCount; j++) {
+                v = _mm_add_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(featureWeights + added[j] * HiddenSize + i)));
+            }
+            for (unsigned j = 0; j < removedCount; j++) {
+                v = _mm_sub_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(featureWeights + removed[j] * HiddenSize + i)));
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(values + i), v);
+        }
+#else
+        for (unsigned i = 0; i < HiddenSize; i++) {
+            int16_t v = previous[i];
+            for (unsigned j = 0; j < addedCount; j++) {
+                v += featureWeights[added[j] * HiddenSize + i];
+            }
+            for (unsigned j = 0; j < removedCount; j++) {
+                v -= featureWeights[removed[j] * HiddenSize + i];
+            }
+            values[i] = v;
+        }
+#endif
+
+    }
+
+    // Sum of the clipped ReLU of the hidden values multiplied with the output weights
+    static int32_t output(const int16_t* values, const int16_t* weights) {
+
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i qa   = _mm256_set1_epi16(QA);
+        __m256i sum = _mm256_setzero_si256();
+        for (unsigned i = 0; i < HiddenSize; i += 16) {
+            const __m256i v = _mm256_min_epi16(_mm256_max_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(values + i)), zero), qa);
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i))));
+        }
+        __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum128);
+#elif defined(__SSE4_1__)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i qa   = _mm_set1_epi16(QA);
+        __m128i sum = _mm_setzero_si128();
+        for (unsigned i = 0; i < HiddenSize; i += 8) {
+            const __m128i v = _mm_min_epi16(_mm_max_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(values + i)), zero), qa);
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i))));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtsi128_si32(sum);
+#else
+        int32_t sum = 0;
+        for (unsigned i = 0; i < HiddenSize; i++) {
+            sum += std::clamp(int(values[i]), 0, QA) * weights[i];
+        }
+        return sum;
+#endif
+
+    }
+
+    // Compute the accumulator of a position from scratch
+    void refresh(const Board& board, Accumulator& accumulator) {
+
+        assert(is_loaded());
+
+        unsigned features[2][32];
+        unsigned count = 0;
+
+        Bitboard occupied = board.pieces(WHITE) | board.pieces(BLACK);
+
+        while (occupied) {
+            const Square sq = pop_lsb(occupied);
+            features[WHITE][count] = feature_index(WHITE, board.owner(sq), board.piecetype(sq), sq);
+            features[BLACK][count] = feature_index(BLACK, board.owner(sq), board.piecetype(sq), sq);
+            count++;
+        }
+
+        for (Color perspective = WHITE; perspective < BOTH; ++perspective) {
+            update_values(featureBiases, accumulator.values[perspective], features[perspective], count, nullptr, 0);
+        }
+
+    }
+
+    // Compute the accumulator after a move from the accumulator before the move and the pieces
+    // the move added to and removed from the board
+    void update(const Accumulator& previous, Accumulator& accumulator, const FeatureChange* added, const unsigned addedCount, const FeatureChange* removed, const unsigned removedCount) {
+
+        assert(is_loaded());
+        assert(addedCount <= 2 && removedCount <= 2);
+
+        unsigned addedFeatures[2];
+        unsigned removedFeatures[2];
+
+        for (Color perspective = WHITE; perspective < BOTH; ++perspective) {
+            for (unsigned i = 0; i < addedCount; i++) {
+                addedFeatures[i] = feature_index(perspective, added[i].color, added[i].pt, added[i].sq);
+            }
+            for (unsigned i = 0; i < removedCount; i++) {
+                removedFeatures[i] = feature_index(perspective, removed[i].color, removed[i].pt, removed[i].sq);
+            }
+            update_values(previous.values[perspective], accumulator.values[perspective], addedFeatures, addedCount, removedFeatures, removedCount);
+        }
+
+    }
+
+    // Evaluate the network for the given accumulator from the perspective of the side to move
+    int evaluate(const Accumulator& accumulator, const Color stm) {
+
+        assert(is_loaded());
+
+        const int64_t sum = int64_t(output(accumulator.values[stm], outputWeights))
+                          + output(accumulator.values[!stm], outputWeights + HiddenSize)
+                          + outputBias;
+
+        return std::clamp(int(sum * Scale / (QA * QB)), -VALUE_MATE_MAX + 1, VALUE_MATE_MAX - 1);
+
+    }
+
+    // Evaluate the network for a position. Uses the accumulator of the board if it is kept up to date
+    int evaluate(const Board& board) {
+
+        if (board.has_accumulator()) {
+            return evaluate(board.accumulator(), board.turn());
+        }
+
+        Accumulator accumulator;
+        refresh(board, accumulator);
+
+        return evaluate(accumulator, board.turn());
+
+    }
+
+}
@@ -0,0 +1,83 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef NNUE_H
+#define NNUE_H
+
+#include <string>
+
+#include "types.hpp"
+
+class Board;
+
+// Efficiently updatable neural network evaluation
+//
+// The network has one input for every piece type of both colors on every square, seen from the
+// perspective of each side: 768 inputs -> 2 x 256 hidden neurons -> 1 output. The hidden layer
+// is kept in an accumulator which is updated incrementally when pieces are added, removed or
+// moved. The output layer applies a clipped ReLU to the accumulator of the side to move and of
+// the other side and sums them up with the output weights.
+namespace NNUE {
+
+    static constexpr unsigned InputSize  = 768;
+    static constexpr unsigned HiddenSize = 256;
+
+    // Quantization of the hidden layer and of the output weights, and the scale to centipawns
+    static constexpr int QA    = 255;
+    static constexpr int QB    = 64;
+    static constexpr int Scale = 400;
+
+    // Hidden layer of the network for both perspectives
+    struct alignas(64) Accumulator {
+        int16_t values[2][HiddenSize];
+    };
+
+    // Index of the input for a piece of the given color and type on a square as seen from a perspective
+    inline unsigned feature_index(const Color perspective, const Color color, const Piecetype pt, const Square sq) {
+        return perspective == WHITE ? 384 * color + 64 * pt + sq
+                                    : 384 * !color + 64 * pt + (sq ^ 56);
+    }
+
+    // A piece added to or removed from the board during a move
+    struct FeatureChange {
+        Color color;
+        Piecetype pt;
+        Square sq;
+    };
+
+    bool load(const std::string& filename);
+    void unload();
+    bool is_loaded();
+
+    // The network is only used if it is loaded and enabled. This must not change during a search
+    bool is_enabled();
+    void set_enabled(const bool enabled);
+
+    void refresh(const Board& board, Accumulator& accumulator);
+    void update(const Accumulator& previous, Accumulator& accumulator, const FeatureChange* added, const unsigned addedCount, const FeatureChange* removed, const unsigned removedCount);
+    int evaluate(const Accumulator& accumulator, const Color stm);
+    int evaluate(const Board& board);
+
+}
+
+#endif
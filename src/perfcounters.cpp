@@ -0,0 +1,200 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "perfcounters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const std::array<std::string, PERF_EVENT_COUNT> PerfEventNames = {
+    "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "dTLB-misses"
+};
+
+#ifdef __linux__
+
+// Event type and configuration for every counted event
+static perf_event_attr event_attributes(const PerfEvent event) {
+
+    static constexpr uint64_t CacheReadMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Needed to scale the counts if the kernel has to multiplex the counters
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    switch (event) {
+        case PERF_CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PERF_INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PERF_BRANCH_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PERF_L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | CacheReadMiss;
+            break;
+        case PERF_LLC_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | CacheReadMiss;
+            break;
+        case PERF_DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | CacheReadMiss;
+            break;
+        default:
+            break;
+    }
+
+    return attr;
+
+}
+
+// Open all counters for the thread with the given system thread id.
+// Returns false if not a single event could be opened
+bool PerfCounters::open(const long threadId) {
+
+    close();
+
+    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+        perf_event_attr attr = event_attributes(PerfEvent(event));
+        fds[event] = syscall(SYS_perf_event_open, &attr, threadId, -1, -1, 0);
+    }
+
+    return is_open();
+
+}
+
+void PerfCounters::close() {
+
+    for (int& fd : fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        fd = -1;
+    }
+
+}
+
+// Reset and enable all counters
+void PerfCounters::start() {
+
+    for (const int fd : fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+}
+
+void PerfCounters::stop() {
+
+    for (const int fd : fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+}
+
+// Read the current counts; counts of multiplexed events are scaled to the full enabled time
+PerfCounts PerfCounters::read() const {
+
+    PerfCounts counts = {};
+
+    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+
+        // Value, time enabled, time running
+        uint64_t values[3] = {};
+
+        if (fds[event] < 0 || ::read(fds[event], values, sizeof(values)) != sizeof(values)) {
+            continue;
+        }
+
+        counts[event] = values[2] ? uint64_t(double(values[0]) * values[1] / values[2]) : values[0];
+
+    }
+
+    return counts;
+
+}
+
+// Close the events which are not supported by the other counters, so that
+// counts of both can be added up event by event
+void PerfCounters::retain(const PerfCounters& other) {
+
+    for (unsigned event = 0; event < PERF_EVENT_COUNT; event++) {
+        if (fds[event] >= 0 && !other.is_supported(PerfEvent(event))) {
+            ::close(fds[event]);
+            fds[event] = -1;
+        }
+    }
+
+}
+
+long current_thread_id() {
+    return syscall(SYS_gettid);
+}
+
+#else
+
+bool PerfCounters::open(const long) { return false; }
+void PerfCounters::close() {}
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+PerfCounts PerfCounters::read() const { return PerfCounts(); }
+void PerfCounters::retain(const PerfCounters&) {}
+
+long current_thread_id() {
+    return 0;
+}
+
+#endif
+
+bool PerfCounters::is_open() const {
+
+    for (const int fd : fds) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+
+    return false;
+
+}
@@ -0,0 +1,75 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <string>
+
+#include "types.hpp"
+
+// Hardware events which can be counted during a search
+enum PerfEvent : unsigned {
+
+    PERF_CYCLES, PERF_INSTRUCTIONS, PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES, PERF_LLC_MISSES, PERF_DTLB_MISSES,
+    PERF_EVENT_COUNT
+
+};
+
+extern const std::array<std::string, PERF_EVENT_COUNT> PerfEventNames;
+
+typedef std::array<uint64_t, PERF_EVENT_COUNT> PerfCounts;
+
+// A set of hardware performance counters attached to a single thread.
+// Counters are only available on Linux through perf_event_open; on other
+// systems or if the kernel does not permit access, no event is supported
+class PerfCounters {
+
+    public:
+
+        PerfCounters() { fds.fill(-1); }
+        PerfCounters(const PerfCounters&) = delete;
+        PerfCounters& operator=(const PerfCounters&) = delete;
+        ~PerfCounters() { close(); }
+
+        bool open(const long threadId);
+        void close();
+        void start();
+        void stop();
+        PerfCounts read() const;
+        void retain(const PerfCounters& other);
+
+        bool is_supported(const PerfEvent event) const { return fds[event] >= 0; }
+        bool is_open() const;
+
+    private:
+
+        std::array<int, PERF_EVENT_COUNT> fds;
+
+};
+
+extern long current_thread_id();
+
+#endif
@@ -26,10 +26,48 @@
 #include "timeman.hpp"
 #include "uci.hpp"
 
+// Update the move type counters for a move played at the last ply of a perft.
+// The board is expected to be in the position after the move has been made.
+static void update_breakdown(PerftInfo& info, Board& board, const Move move, const MoveType type, const bool capture) {
+
+    if (capture)               info.capturesCount++;
+    if (type == ENPASSANT)     info.enPassantCount++;
+    if (type == CASTLING)      info.castlesCount++;
+    if (is_promotion(move))    info.promotionsCount++;
+
+    const Bitboard checkers = board.checkers();
+
+    if (!checkers) {
+        return;
+    }
+
+    info.checksCount++;
+
+    // The moved piece is the castling rook for castling moves, otherwise the piece on the target square
+    const Square toSq    = to_sq(move);
+    const Square movedSq = (type == CASTLING) ? toSq + ((toSq == SQUARE_G1 || toSq == SQUARE_G8) ? 1 : -1) : toSq;
+
+    // A check is discovered if it is given by other pieces than the moved one only
+    if (!(checkers & SQUARES[movedSq])) {
+        info.discoveredChecksCount++;
+    }
+
+    if (popcount(checkers) >= 2) {
+        info.doubleChecksCount++;
+    }
+
+    if (generate_moves<ALL, LEGAL>(board, board.turn()).size() == 0) {
+        info.matesCount++;
+    }
+
+}
+
 // Runs a performance test to a given depth.
 // This method returns the total number of nodes visited
 // by traversing the search tree and counting the number of all positions
-// which may occur until a given depth.
+// which may occur until a given depth. If Breakdown is set, the moves played
+// at the last ply are additionally classified by their type.
+template<bool Breakdown>
 static uint64_t recursive_traverse(int depth, PerftInfo& info, Board& board) {
 
     if (depth == 0) return 1;
@@ -42,10 +80,20 @@ static uint64_t recursive_traverse(int depth, PerftInfo& info, Board& board) {
     for (unsigned i = 0; i < moves.size(); i++) {
         Move move = moves[i];
 
+        // Flags have to be obtained before the move is played
+        const MoveType type = move_type(move);
+        const bool capture  = Breakdown && depth == 1 && board.is_capture(move);
+
         board.do_move(move);
 
         // Recursive call
-        uint64_t nodes = recursive_traverse(depth - 1, info, board);
+        uint64_t nodes = recursive_traverse<Breakdown>(depth - 1, info, board);
+
+        if constexpr (Breakdown) {
+            if (depth == 1) {
+                update_breakdown(info, board, move, type, capture);
+            }
+        }
 
         // If we are in a root node, add the number of nodes for divide
         if (depth == info.depth) {
@@ -81,7 +129,7 @@ std::vector<uint64_t> runPerft(const std::string& fen, const Depth maxDepth) {
         info.depth = depth;
         
         TimePoint iterationStart = Clock::now();
-        nodes = recursive_traverse(depth, info, board);
+        nodes = recursive_traverse<false>(depth, info, board);
         Duration duration = get_time_elapsed(iterationStart);
 
         results.push_back(nodes);
@@ -99,6 +147,50 @@ std::vector<uint64_t> runPerft(const std::string& fen, const Depth maxDepth) {
 
 }
 
+// Same as runPerft, but the moves are classified by their type on each depth.
+// The output resembles the usual perft tables with captures, en-passants, castles,
+// promotions, checks, discovered checks, double checks and mates.
+std::vector<PerftInfo> runPerftBreakdown(const std::string& fen, const Depth maxDepth) {
+
+    std::cout << "Starting perft breakdown to maximum depth of " << maxDepth << "..." << std::endl << std::endl;
+
+    Board board;
+    board.set_fen(fen);
+
+    std::vector<PerftInfo> results;
+
+    TimePoint start = Clock::now();
+
+    std::cout << "Depth" << std::setw(13) << "Nodes"
+              << std::setw(11) << "Captures" << std::setw(9) << "E.p."
+              << std::setw(9) << "Castles" << std::setw(11) << "Promotions"
+              << std::setw(10) << "Checks" << std::setw(11) << "Disc. ch."
+              << std::setw(11) << "Double ch." << std::setw(9) << "Mates" << std::endl;
+
+    for (Depth depth = 1; depth < maxDepth+1; depth++) {
+        PerftInfo info;
+        info.depth = depth;
+        info.nodes = recursive_traverse<true>(depth, info, board);
+
+        std::cout << std::setw(5) << depth << std::setw(13) << info.nodes
+                  << std::setw(11) << info.capturesCount << std::setw(9) << info.enPassantCount
+                  << std::setw(9) << info.castlesCount << std::setw(11) << info.promotionsCount
+                  << std::setw(10) << info.checksCount << std::setw(11) << info.discoveredChecksCount
+                  << std::setw(11) << info.doubleChecksCount << std::setw(9) << info.matesCount << std::endl;
+
+        results.push_back(info);
+    }
+
+    Duration duration = get_time_elapsed(start);
+
+    std::cout << std::endl;
+    std::cout << "Perft breakdown finished." << std::endl;
+    std::cout << "Total duration: " << ((float)duration / 1000.0f) << "s" << std::endl;
+
+    return results;
+
+}
+
 // A divide test is a special kind of perft test which returns the number of positions
 // that occured from each root move played for a given position. A divide test runs
 // to a fixed depth only.
@@ -112,7 +204,7 @@ uint64_t runDivide(const std::string& fen, const Depth depth) {
     Board board;
     board.set_fen(fen);
 
-    const uint64_t nodes = recursive_traverse(depth, info, board);
+    const uint64_t nodes = recursive_traverse<false>(depth, info, board);
 
     // Generate all legal moves for the root position
     MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
@@ -30,15 +30,21 @@
 struct PerftInfo {
 
     Depth depth = 0;
+    uint64_t nodes = 0;
     uint64_t divide[MOVES_MAX_COUNT] = { 0 };
     uint64_t capturesCount = 0;
     uint64_t enPassantCount = 0;
     uint64_t castlesCount = 0;
     uint64_t promotionsCount = 0;
+    uint64_t checksCount = 0;
+    uint64_t discoveredChecksCount = 0;
+    uint64_t doubleChecksCount = 0;
+    uint64_t matesCount = 0;
 
 };
 
 extern std::vector<uint64_t> runPerft(const std::string& fen, const Depth depth);
+extern std::vector<PerftInfo> runPerftBreakdown(const std::string& fen, const Depth depth);
 extern uint64_t runDivide(const std::string& fen, const Depth depth);
 
 #endif
@@ -22,6 +22,8 @@
 */
 
 #include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #include "search.hpp"
 #include "thread.hpp"
@@ -36,6 +38,64 @@
 // been played.
 static int LMRTable[DEPTH_MAX][MOVES_MAX_COUNT];
 
+#ifdef SEARCH_TRACE
+// Writes the trace record of a node when the node is left. The record
+// contains the number of nodes searched below, so records are in post-order
+class NodeTracer {
+
+    public:
+
+        NodeTracer(SearchInfo* i, const SearchStack* ss, Depth d, Value a, Value b, TraceNodeType t)
+            : info(i), writer(i->thread->trace), startNodes(i->nodes), move((ss - 1)->currentMove), plies(ss->plies), depth(d), alpha(a), beta(b), type(t) {}
+
+        ~NodeTracer() {
+
+            if (writer.is_open()) {
+                writer.write({
+                    uint32_t(std::min(info->nodes - startNodes + 1, uint64_t(UINT32_MAX))),
+                    move,
+                    int16_t(alpha), int16_t(beta), int16_t(result),
+                    uint8_t(plies), int8_t(depth), type, exitReason
+                });
+            }
+
+        }
+
+        Value exit(const Value value, const TraceExit reason) {
+            result = value;
+            exitReason = reason;
+            return value;
+        }
+
+    private:
+
+        SearchInfo* info;
+        TraceWriter& writer;
+        uint64_t startNodes;
+        Move move;
+        Depth plies, depth;
+        Value alpha, beta, result = VALUE_NONE;
+        TraceNodeType type;
+        TraceExit exitReason = EXIT_SEARCHED;
+
+};
+
+#define TRACE_NODE(...) NodeTracer tracer(__VA_ARGS__)
+#define TRACE_EXIT(value, reason) tracer.exit(value, reason)
+#else
+#define TRACE_NODE(...) ((void)0)
+#define TRACE_EXIT(value, reason) (value)
+#endif
+
+const std::array<std::string, STAT_COUNT> SearchStatNames = {
+    "PV nodes", "Cut nodes", "All nodes", "QSearch nodes",
+    "Beta cutoffs", "First move cutoffs", "TT cutoffs",
+    "Null move tries", "Null move cutoffs", "Razoring", "Futility prunes",
+    "LMR searches", "LMR re-searches", "Singular searches", "Singular extensions",
+    "Delta prunes", "SEE prunes", "Lazy evaluations", "Lazy eval exits",
+    "Pawn table probes", "Pawn table hits", "Eval cache probes", "Eval cache hits"
+};
+
 namespace Search {
     // Initializes search parameters which are computed at execution time
     void init() {
@@ -49,32 +109,30 @@ namespace Search {
     }
 }
 
-// Update a principal variations
-void PrincipalVariation::update(const Move bestMove, const PrincipalVariation& pv) {
-
-    size = 0;
-    line[size] = bestMove;
-    ++size;
+// Update the principal variation at the given ply with a new best move, followed by the line of the child node
+void PrincipalVariation::update(const Depth plies, const Move bestMove) {
 
-    unsigned i;
-    for (i = 0; i < pv.size; i++) {
-        line[size + i] = pv.line[i];
-    }
-    size += i;
+    lines[plies][0] = bestMove;
+    std::copy_n(lines[plies + 1].begin(), lengths[plies + 1], lines[plies].begin() + 1);
+    lengths[plies] = lengths[plies + 1] + 1;
 
 }
 
 void SearchInfo::reset() {
 
-    hashTableHits = nodes = depth = selectiveDepth = pvStability = multiPv = 0;
+    hashTableHits = hashTableProbes = nodes = depth = selectiveDepth = completedDepth = pvStability = multiPv = 0;
+    independent = stopped = false;
+    completedPv.clear();
     idealTime = maxTime = 0;
 
     bestMove.fill(MOVE_NONE);
-    currentMove.fill(MOVE_NONE);
     multiPvMoves.fill(MOVE_NONE);
-    eval.fill(0);
     value.fill(0);
 
+#ifdef SEARCH_STATS
+    stats.fill(0);
+#endif
+
 }
 
 static Value get_draw_value(Depth depth, SearchInfo* info) {
@@ -96,16 +154,29 @@ static Value get_mate_value(Depth plies) {
 }
 
 // Check it the allocated time for the current search is up
+// An independent search only counts its own nodes and only stops itself
 static void check_finished(SearchInfo* info) {
 
-    if (   ((info->limits.time || info->limits.moveTime) && is_time_exceeded(info))
-        || (info->limits.nodes && Threads.get_nodes() >= info->limits.nodes))
+    if (   ((info->limits.time || info->limits.moveTime) && (info->independent || !Threads.is_pondering()) && is_time_exceeded(info))
+        || (info->limits.nodes && (info->independent ? info->nodes.load() : Threads.get_nodes()) >= info->limits.nodes))
     {
-        Threads.stop_searching();
+        if (info->independent) {
+            info->stopped = true;
+        } else {
+            Threads.stop_searching();
+        }
     }
 
 }
 
+// Check if the search has been stopped, either for all threads or for an independent search alone.
+// Standalone threads are not part of the pool and are only stopped by their own flag
+static inline bool has_stopped(const SearchInfo* info) {
+
+    return info->stopped || (!info->standalone && Threads.has_stopped());
+
+}
+
 // Get the locations of the least valuable piece of a given set of attackers for a given color
 // If no attacker was found, return SQUARE_NONE
 unsigned Board::least_valuable_piece(Bitboard attackers, const Color color) const {
@@ -122,92 +193,169 @@ unsigned Board::least_valuable_piece(Bitboard attackers, const Color color) cons
 }
 
 // Static Exchange Evaluation
-// The function takes a given move and returns the total material gain which can be obtained
-// by moving the piece to the target square. The function finished once the target square is
-// "quiet", meaning there are no more potential attackers to the square or one player has run
-// out of attacking pieces.
+// The function takes a given move and returns the material gain which can be obtained by
+// moving the piece to the target square. Both sides capture on the target square with their
+// least valuable attacker in turn, and each side may stop capturing once continuing would lose
+// material. The king only captures if the opponent has no more attackers.
 Value Board::see(const Move move) const {
 
     if (move_type(move) != NORMAL) {
         return 0;
     }
 
-    Square fromSq = from_sq(move);
-    Square toSq   = to_sq(move);
+    Square toSq = to_sq(move);
 
-    Color color = !stm;
+    // If the opponent attacks neither the target square nor the origin square, which could
+    // reveal one of its sliders, the moving piece cannot be captured in return
+    if (has_attack_map() && !(attack_map().colorAttacks[!stm] & (SQUARES[toSq] | SQUARES[from_sq(move)]))) {
+        return SeeMaterial[pieceTypes[toSq]];
+    }
+
+    Color color = stm;
 
     Bitboard mayXray   = bbPieces[PAWN] | bbPieces[BISHOP] | bbPieces[ROOK] | bbPieces[QUEEN]; // pieces which may reveal a slider once removed from the board
     Bitboard occupied  = bbColors[BOTH];
     Bitboard attackers = sq_attackers(WHITE, toSq, occupied) | sq_attackers(BLACK, toSq, occupied); // all attackers to the target square
 
-    Square attacker = fromSq;
-    Piecetype victim = PIECE_NONE;
+    // Material balance after each capture in the sequence, from the view of the capturing side
+    Value gain[32];
+    unsigned depth = 0;
 
-    // If the move is a capture; set the initial victim piece type
-    if (is_ep(move)) {
-        victim = PAWN;
-    } else {
-        if (pieceTypes[toSq] != PIECE_NONE) {
-            victim = pieceTypes[toSq];
+    Square attacker = from_sq(move);
+    gain[0] = SeeMaterial[pieceTypes[toSq]];
+
+    // Start the Static Exchange Evaluation Loop
+    do {
+
+        depth++;
+
+        // Speculative balance if the current attacker gets captured in return
+        gain[depth] = SeeMaterial[pieceTypes[attacker]] - gain[depth - 1];
+
+        // Remove the attacker from the board and from potential attackers. The moving piece
+        // of a non-capture is not an attacker of the target square
+        occupied  ^= SQUARES[attacker];
+        attackers &= occupied;
+
+        // By moving the attacker, a new attacker could have been revealed
+        if (SQUARES[attacker] & mayXray) {
+            attackers |= slider_attackers(toSq, occupied) & occupied;
         }
 
+        // Get the next attacker, which is the least valuable piece of the opposite color attacking the square
+        color = !color;
+        attacker = least_valuable_piece(attackers, color);
+
+        // The king cannot capture if the square is still defended
+        if (attacker != SQUARE_NONE && pieceTypes[attacker] == KING && (attackers & bbColors[!color])) {
+            attacker = SQUARE_NONE;
+        }
+
+    } while (attacker != SQUARE_NONE);
+
+    // Go back through the sequence; each side chooses between capturing and standing pat
+    while (--depth) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
     }
 
-    Value value = 0;
+    return gain[0];
 
-    // Start the Static Exchange Evaluation Loop
-    do {
+}
+
+// Check whether the Static Exchange Evaluation of a move is at least the given threshold.
+// Equal to see(move) >= threshold, but returns as soon as the result is decided: once a side
+// has a balance which the opponent cannot change anymore by continuing to capture
+bool Board::see_ge(const Move move, const Value threshold) const {
+
+    if (move_type(move) != NORMAL) {
+        return 0 >= threshold;
+    }
+
+    Square fromSq = from_sq(move);
+    Square toSq   = to_sq(move);
+
+    // If capturing the victim for free does not reach the threshold, we cannot succeed
+    Value balance = SeeMaterial[pieceTypes[toSq]] - threshold;
+    if (balance < 0) {
+        return false;
+    }
+
+    // If the moving piece cannot be captured in return, the victim is won for free
+    if (has_attack_map() && !(attack_map().colorAttacks[!stm] & (SQUARES[toSq] | SQUARES[fromSq]))) {
+        return true;
+    }
+
+    // If losing the moving piece in return still reaches the threshold, we cannot fail
+    balance = SeeMaterial[pieceTypes[fromSq]] - balance;
+    if (balance <= 0) {
+        return true;
+    }
+
+    Bitboard mayXray   = bbPieces[PAWN] | bbPieces[BISHOP] | bbPieces[ROOK] | bbPieces[QUEEN];
+    Bitboard occupied  = bbColors[BOTH] ^ SQUARES[fromSq];
+    Bitboard attackers = (sq_attackers(WHITE, toSq, occupied) | sq_attackers(BLACK, toSq, occupied)) & occupied;
+
+    if (SQUARES[fromSq] & mayXray) {
+        attackers |= slider_attackers(toSq, occupied) & occupied;
+    }
+
+    Color color = stm;
+    bool result = true; // Result if the side to move of the exchange stops capturing
+
+    while (true) {
 
-        // Flip the current color to play
         color = !color;
 
-        // If it is our turn, add the victim material value to the balance, otherwise subtract it
-        if (color == stm) {
-            value += SeeMaterial[victim];
-        } else {
-            value -= SeeMaterial[victim];
+        Square attacker = least_valuable_piece(attackers, color);
+        if (attacker == SQUARE_NONE) {
+            break;
         }
 
-        // Set the new victim, which is the current attacker
-        victim = pieceTypes[attacker];
+        // The king can only capture if the opponent has no more attackers, otherwise the side loses the exchange
+        if (pieceTypes[attacker] == KING) {
+            return (attackers & bbColors[!color]) ? result : !result;
+        }
+
+        result = !result;
+
+        // Balance for the current side if its attacker is captured in return. If it is still
+        // below the result the side is satisfied with, the exchange ends here
+        balance = SeeMaterial[pieceTypes[attacker]] - balance;
+        if (balance < static_cast<Value>(result)) {
+            break;
+        }
 
-        // Remove the attacker from potential attackers
         attackers ^= SQUARES[attacker];
         occupied  ^= SQUARES[attacker];
 
-        // By moving the attacker, a new attacker could have been revealed
         if (SQUARES[attacker] & mayXray) {
             attackers |= slider_attackers(toSq, occupied) & occupied;
         }
 
-        // Get the next attacker, which is the least valuable piece of the opposite color attacking the square
-        attacker = least_valuable_piece(attackers, !color);
-
-    } while (attacker != SQUARE_NONE && pieceTypes[attacker] != KING); // Stop the loop if a player has run out of attackers or the king is the final attacker
+    }
 
-    return value;
+    return result;
 
 }
 
 // Update killer, counter move and history statistics for a quiet best move
-static void update_quiet_stats(Thread *thread, const Board& board, SearchInfo *info, const Depth plies, const Depth depth, const MoveList& quiets, const Move bestMove) {
+static void update_quiet_stats(Thread *thread, const Board& board, SearchStack *ss, const Depth depth, const MoveList& quiets, const Move bestMove) {
 
     // Set the move as new killer move for the current ply if it not already is
-    if (bestMove != thread->killers.first(plies)) {
-        thread->killers.update(plies, bestMove);
+    if (bestMove != ss->killers[0]) {
+        ss->update_killers(bestMove);
     }
 
     // If the previous search depth was not a null move search, set the counter move
-    if (info->currentMove[plies-1] != MOVE_NONE) {
-        const Square prevSq = to_sq(info->currentMove[plies-1]);
+    if ((ss - 1)->currentMove != MOVE_NONE) {
+        const Square prevSq = to_sq((ss - 1)->currentMove);
         thread->counterMove.set_move(board.owner(prevSq), board.piecetype(prevSq), prevSq, bestMove);
     }
 
     // The history bonus should rise exponentially with depth
     int bonus = std::min(400, depth * depth);
 
-    // Update the history table.
+    // Update the history and continuation history tables.
     // Increase the value of the best move found and decrease it for all other moves
     for (const Move& move : quiets) {
         Square fromSq = from_sq(move);
@@ -216,6 +364,30 @@ static void update_quiet_stats(Thread *thread, const Board& board, SearchInfo *i
 
         int delta = (move == bestMove) ? bonus : -bonus;
         thread->history.update_score(board.turn(), pt, toSq, delta);
+
+        // Skip the continuation histories if the earlier ply was a null move or is before the root
+        if ((ss - 1)->currentMove != MOVE_NONE) {
+            (ss - 1)->continuationHistory->update_score(board.turn(), pt, toSq, delta);
+        }
+        if ((ss - 2)->currentMove != MOVE_NONE) {
+            (ss - 2)->continuationHistory->update_score(board.turn(), pt, toSq, delta);
+        }
+    }
+
+}
+
+// Update the capture history after a fail high. If the best move is a capture its value is
+// increased, all other captures searched are decreased
+static void update_capture_stats(Thread *thread, const Board& board, const Depth depth, const MoveList& captures, const Move bestMove) {
+
+    int bonus = std::min(400, depth * depth);
+
+    for (const Move& move : captures) {
+        Square toSq = to_sq(move);
+        Piecetype captured = is_ep(move) ? PAWN : board.piecetype(toSq);
+
+        int delta = (move == bestMove) ? bonus : -bonus;
+        thread->captureHistory.update_score(board.turn(), board.piecetype(from_sq(move)), toSq, captured, delta);
     }
 
 }
@@ -236,43 +408,53 @@ static bool multipv_move_played(const SearchInfo* info, const Move move) {
 // This function uses the alpha-beta algorithm just like the search() method, however, it only
 // searches captures and evasions until the position is "quiet", meaning there are no more captures
 // or checks. This is important so the engine does not suffer from the horizon effect.
-static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& board, SearchInfo *info) {
+static Value qsearch(Value alpha, Value beta, Depth depth, SearchStack *ss, Board& board, SearchInfo *info) {
+
+    const Depth plies = ss->plies;
 
     assert(alpha >= -VALUE_INFINITE && beta <= VALUE_INFINITE && alpha < beta); // alpha and beta have to be within the given bounds; always alpha < beta!
 
     info->nodes++; // Increase the number of total nodes visited
     info->selectiveDepth = std::max(info->selectiveDepth, plies); // Set the current selective depth
 
-    if (info->isMainThread && (info->nodes & 1023) == 1023) {
+    SEARCH_STAT(info, STAT_QSEARCH_NODES);
+
+    TRACE_NODE(info, ss, depth, alpha, beta, TRACE_QSEARCH);
+
+    if ((info->isMainThread || info->independent) && (info->nodes & 1023) == 1023) {
         check_finished(info);
     }
 
     const bool inCheck = board.checkers();
 
     // Check if the search has been stopped or the current position is a draw
-    if (Threads.has_stopped() || board.check_draw()) {
-        return VALUE_DRAW;
+    if (has_stopped(info) || board.check_draw()) {
+        return TRACE_EXIT(VALUE_DRAW, EXIT_DRAW);
     }
 
     if (plies >= DEPTH_MAX) {
-        return inCheck ? VALUE_DRAW : evaluate(board, info->threadIndex);
+        return TRACE_EXIT(inCheck ? VALUE_DRAW : evaluate(board, *info->thread), EXIT_MAX_PLY);
     }
 
     const bool pvNode = (beta - alpha != 1); // Check if we are in a pv node (no zero window search)
 
-    Thread *thread = Threads.get_thread(info->threadIndex);
+    Thread *thread = info->thread;
     Value bestValue, value, eval, deltaBase, deltaValue;
     bool ttHit = false;
+    bool evalComplete = true;
 
     const Value oldAlpha = alpha;
     const Depth ttDepth  = (inCheck || depth >= 0) ? 0 : -1; // Set the depth for the transposition table entry (is constant because quiescent search depth is relative and would be invalid in further iterations)
 
-    info->currentMove[plies] = MOVE_NONE;
+    ss->currentMove = MOVE_NONE;
 
     // Probe the Transposition Table
     TTEntry * entry = TTable.probe(board.hashkey(), ttHit);
     Move ttMove = MOVE_NONE;
 
+    info->hashTableProbes++;
+    info->hashTableHits += ttHit;
+
     if (   !pvNode
         && ttHit
         && entry->depth() >= ttDepth) {
@@ -285,7 +467,8 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
              || (entry->bound() == BOUND_UPPER && ttValue <= alpha)
              || (entry->bound() == BOUND_LOWER && ttValue >= beta)))
         {
-            return ttValue;
+            SEARCH_STAT(info, STAT_TT_CUTOFFS);
+            return TRACE_EXIT(ttValue, EXIT_TT_CUTOFF);
         }
 
     }
@@ -298,20 +481,21 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
     } else {
 
         // Check if we can use the evaluation of the transposition table entry so we do not have
-        // to recompute it
-        if (ttHit) {
-            eval = entry->eval();
-            if (eval == VALUE_NONE) {
-                eval = evaluate(board, info->threadIndex);
+        // to recompute it. Otherwise evaluate lazily: we only need to know how the evaluation
+        // compares to the window if it is far outside of it
+        eval = ttHit ? entry->eval() : VALUE_NONE;
+        if (eval == VALUE_NONE) {
+            eval = evaluate(board, *thread, alpha, beta, evalComplete);
+            SEARCH_STAT(info, STAT_LAZY_EVALS);
+            if (!evalComplete) {
+                SEARCH_STAT(info, STAT_LAZY_EVAL_EXITS);
             }
-        } else {
-            eval = evaluate(board, info->threadIndex);
         }
 
-        info->eval[plies] = bestValue = eval;
+        ss->staticEval = bestValue = eval;
 
         if (bestValue >= beta) {
-            return bestValue;
+            return TRACE_EXIT(bestValue, EXIT_STAND_PAT);
         }
 
         if (pvNode && bestValue > alpha) {
@@ -327,7 +511,7 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
     Move bestMove = MOVE_NONE;
     Move move;
 
-    MovePicker picker(board, info, &thread->history, plies, info->currentMove[plies-1], ttMove);
+    MovePicker picker(board, ss, &thread->history, &thread->captureHistory, ttMove);
 
     while ( (move = picker.pick()) != MOVE_NONE ) {
 
@@ -338,6 +522,7 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
         movesCount++;
 
         const bool givesCheck = board.gives_check(move);
+        bool seeWinning = false;
 
         // Delta pruning (futility pruning in quiescent search)
         if (   !inCheck
@@ -346,35 +531,43 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
             && !board.is_dangerous_pawn_push(move))
         {
 
-            deltaValue = deltaBase + Material[board.piecetype(to_sq(move))].eg;
+            deltaValue = deltaBase + Material[board.piecetype(to_sq(move))].eg();
 
             // If alpha is already above the material gain by DeltaMargin,
             // prune the move.
             if (deltaValue <= alpha) {
                 bestValue = std::max(bestValue, deltaValue);
+                SEARCH_STAT(info, STAT_DELTA_PRUNES);
                 continue;
             }
 
             // Also prune the move if the move is not gaining or losing
             // any material and is still below the best value + DeltaMargin
-            if (deltaBase <= alpha && board.see(move) <= 0) {
-                bestValue = std::max(bestValue, deltaBase);
-                continue;
+            if (deltaBase <= alpha) {
+                if (!board.see_ge(move, 1)) {
+                    bestValue = std::max(bestValue, deltaBase);
+                    SEARCH_STAT(info, STAT_DELTA_PRUNES);
+                    continue;
+                }
+
+                // The move gains material, so it cannot lose material either
+                seeWinning = true;
             }
 
         }
 
         // Prune moves with a negative static exchange evaluation
-        if (!inCheck && board.see(move) < 0) {
+        if (!inCheck && !seeWinning && !board.see_ge(move, 0)) {
+            SEARCH_STAT(info, STAT_SEE_PRUNES);
             continue;
         }
 
         board.do_move(move);
 
-        info->currentMove[plies] = move;
+        ss->currentMove = move;
 
         // Recursive quiescent search. Flip alpha and beta
-        value = -qsearch(-beta, -alpha, depth - 1, plies + 1, board, info);
+        value = -qsearch(-beta, -alpha, depth - 1, ss + 1, board, info);
 
         board.undo_move();
 
@@ -397,31 +590,35 @@ static Value qsearch(Value alpha, Value beta, Depth depth, Depth plies, Board& b
 
     // If we are in check and there are no legal moves, return a mate value
     if (inCheck && movesCount == 0) {
-        return get_mated_value(plies);
+        return TRACE_EXIT(get_mated_value(plies), EXIT_NO_MOVES);
     }
 
     // Store the value, evaluation and best move found in a transposition table entry
-    TTable.store(board.hashkey(), ttDepth, value_to_tt(bestValue, plies), eval, bestMove, bestValue >= beta ? BOUND_LOWER : pvNode && bestValue > oldAlpha ? BOUND_EXACT : BOUND_UPPER);
+    // A lazy evaluation is not stored, since it is only valid for the current window
+    TTable.store(board.hashkey(), ttDepth, value_to_tt(bestValue, plies), evalComplete ? eval : VALUE_NONE, bestMove, bestValue >= beta ? BOUND_LOWER : pvNode && bestValue > oldAlpha ? BOUND_EXACT : BOUND_UPPER);
     
     assert(bestValue > -VALUE_INFINITE && bestValue < VALUE_INFINITE);
     
-    return bestValue;
+    return TRACE_EXIT(bestValue, bestValue >= beta ? EXIT_BETA_CUTOFF : EXIT_SEARCHED);
 
 }
 
 // The main search function using an alpha-beta search algorithm. This is where the magic happens.
 // The function takes alpha and beta as parameters, with alpha being the lowest value we can expect and beta the highest.
 // Depth determines the number of plies we will look ahead, while plies represent the real number of moves actually played so far since depth can be increased/decreased dynamically during search
-static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutNode, Board& board, SearchInfo *info, PrincipalVariation& pv, bool pruning, Move excluded = MOVE_NONE) {
+static Value search(Value alpha, Value beta, Depth depth, SearchStack *ss, bool cutNode, Board& board, SearchInfo *info, bool pruning) {
 
-    if (info->isMainThread && (info->nodes & 1023) == 1023) {
+    const Depth plies = ss->plies;
+    const Move excluded = ss->excludedMove;
+
+    if ((info->isMainThread || info->independent) && (info->nodes & 1023) == 1023) {
         check_finished(info);
     }
 
     // If we have gone this far in the search tree, do not look any further but descend into a quiescent search.
     // This means we will still look ahead until the position is "quiet"
     if (depth <= 0) {
-        return qsearch(alpha, beta, 0, plies, board, info);
+        return qsearch(alpha, beta, 0, ss, board, info);
     }
 
     assert(alpha >= -VALUE_INFINITE && beta <= VALUE_INFINITE && alpha < beta); // alpha and beta have to be within the given bounds; always alpha < beta!
@@ -435,45 +632,50 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
 
     assert(!(pvNode && cutNode));
 
+    SEARCH_STAT(info, pvNode ? STAT_PV_NODES : cutNode ? STAT_CUT_NODES : STAT_ALL_NODES);
+
+    TRACE_NODE(info, ss, depth, alpha, beta, pvNode ? TRACE_PV : cutNode ? TRACE_CUT : TRACE_ALL);
+
     const bool inCheck = board.checkers();
 
     if (!rootNode) {
         // Check if the search has been stopped or the current position is a draw
-        if (Threads.has_stopped()) {
-            return VALUE_DRAW;
+        if (has_stopped(info)) {
+            return TRACE_EXIT(VALUE_DRAW, EXIT_STOPPED);
         }
         
         // Checks for draw by 50-move rule or 3-fold repetition
         if (board.check_draw()) {
-            return VALUE_DRAW; //TODO: This does not work yet: get_draw_value(depth, info);
+            return TRACE_EXIT(VALUE_DRAW, EXIT_DRAW); //TODO: This does not work yet: get_draw_value(depth, info);
         }
 
         if (plies >= DEPTH_MAX) {
-            return inCheck ? VALUE_DRAW : evaluate(board, info->threadIndex);
+            return TRACE_EXIT(inCheck ? VALUE_DRAW : evaluate(board, *info->thread), EXIT_MAX_PLY);
         }
 
         // Mate Distance Pruning
         alpha = std::max(get_mated_value(plies), alpha);
         beta  = std::min(get_mate_value(plies + 1), beta);
         if (alpha >= beta) {
-            return alpha;
+            return TRACE_EXIT(alpha, EXIT_MATE_DISTANCE);
         }
 
     }
     
 
-    Thread *thread = Threads.get_thread(info->threadIndex);
-    PrincipalVariation newPv;
+    Thread *thread = info->thread;
     MoveList quietMoves;
+    MoveList captureMoves;
     bool ttHit = false;
     bool improving = false;
     unsigned movesCount = 0;
     Value value, bestValue, ttValue, eval;
     value = bestValue = -VALUE_INFINITE;
-    ttValue = eval = info->eval[plies] = VALUE_NONE;
+    ttValue = eval = ss->staticEval = VALUE_NONE;
 
-    info->currentMove[plies] = MOVE_NONE;
-    thread->killers.clear(plies + 1);
+    ss->currentMove = MOVE_NONE;
+    ss->continuationHistory = thread->continuationHistory.sentinel();
+    (ss + 1)->clear_killers();
 
     TTEntry * entry;
     Move ttMove = MOVE_NONE;
@@ -483,6 +685,9 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
 
         entry = TTable.probe(board.hashkey(), ttHit);
 
+        info->hashTableProbes++;
+        info->hashTableHits += ttHit;
+
         if (ttHit) {
 
             ttMove = entry->move();
@@ -492,7 +697,8 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
                 if ((entry->bound() == BOUND_EXACT)
                     || (entry->bound() == BOUND_UPPER && ttValue <= alpha)
                     || (entry->bound() == BOUND_LOWER && ttValue >= beta)) {
-                    return ttValue;
+                    SEARCH_STAT(info, STAT_TT_CUTOFFS);
+                    return TRACE_EXIT(ttValue, EXIT_TT_CUTOFF);
                 }
             }
 
@@ -507,18 +713,18 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
         if (ttHit) {
             eval = entry->eval();
             if (eval == VALUE_NONE) {
-                eval = evaluate(board, info->threadIndex);
+                eval = evaluate(board, *thread);
             }
             
         } else {
-            eval = evaluate(board, info->threadIndex);
+            eval = evaluate(board, *thread);
             TTable.store(board.hashkey(), DEPTH_NONE, VALUE_NONE, eval, MOVE_NONE, BOUND_NONE);
         }
 
-        info->eval[plies] = eval;
+        ss->staticEval = eval;
 
         // Check if the evaluation is improving since our last turn
-        improving = plies >= 2 && (eval >= info->eval[plies - 2] || info->eval[plies - 2] == VALUE_NONE);
+        improving = plies >= 2 && (eval >= (ss - 2)->staticEval || (ss - 2)->staticEval == VALUE_NONE);
 
     }
 
@@ -532,7 +738,8 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
             && depth == 1
             && eval <= alpha - RazorMargin)
         {
-            return qsearch(alpha, beta, 0, plies, board, info);
+            SEARCH_STAT(info, STAT_RAZORING);
+            return TRACE_EXIT(qsearch(alpha, beta, 0, ss, board, info), EXIT_RAZORING);
         }
 
         // Null move pruning
@@ -546,12 +753,16 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
             && board.minors_and_majors(board.turn())
             && eval >= beta)
         {
+            SEARCH_STAT(info, STAT_NULL_MOVE_TRIES);
+
             board.do_nullmove();
-            value = -search(-beta, -beta + 1, depth - (2 + (32 * depth + std::min(eval - beta, 512)) / 128), plies + 1, !cutNode, board, info, newPv, false);
+            value = -search(-beta, -beta + 1, depth - (2 + (32 * depth + std::min(eval - beta, 512)) / 128), ss + 1, !cutNode, board, info, false);
             board.undo_nullmove();
 
             if (value >= beta) {
 
+                SEARCH_STAT(info, STAT_NULL_MOVE_CUTOFFS);
+
                 // We cannot trust mate values from null move search
                 if (value >= VALUE_MATE_MAX) {
                     value = beta;
@@ -559,7 +770,7 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
 
                 // Only return if there is no mate at higher depth
                 if (std::abs(beta) < VALUE_MATE_MAX) {
-                    return value;
+                    return TRACE_EXIT(value, EXIT_NULL_MOVE);
                 }
 
             }
@@ -579,7 +790,7 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
         && depth >= 6)
     {
 
-        value = search(alpha, beta, depth - 2, plies + 1, cutNode, board, info, newPv, pruning);
+        value = search(alpha, beta, depth - 2, ss + 1, cutNode, board, info, pruning);
 
         entry = TTable.probe(board.hashkey(), ttHit);
 
@@ -589,7 +800,7 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
     }
 
     // Initialize the move picker
-    MovePicker picker(board, info, thread->killers, &thread->history, thread->counterMove, plies, ttMove);
+    MovePicker picker(board, ss, &thread->history, &thread->captureHistory, thread->counterMove, ttMove);
 
     Move move;
     Depth newDepth;
@@ -612,9 +823,11 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
         bool promotion  = is_promotion(move);
         bool quiet      = !capture && !promotion;
 
-        // Add quiet moves to a list
+        // Add quiet moves and captures to a list
         if (quiet) {
             quietMoves.append(move);
+        } else if (capture) {
+            captureMoves.append(move);
         }
 
         // Quiet Move Pruning
@@ -632,6 +845,7 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
                 && depth <= 5
                 && eval + FutilityMargin[depth] <= alpha)
             {
+                SEARCH_STAT(info, STAT_FUTILITY_PRUNES);
                 continue;
             }
         }
@@ -657,26 +871,32 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
             && board.is_legal(move))
         {
             Value rbeta = std::max(ttValue - 2 * depth, -VALUE_MATE);
-            value = search(rbeta - 1, rbeta, depth / 2, plies + 1, cutNode, board, info, newPv, false, move);
+            (ss + 1)->excludedMove = move;
+            value = search(rbeta - 1, rbeta, depth / 2, ss + 1, cutNode, board, info, false);
+            (ss + 1)->excludedMove = MOVE_NONE;
+            SEARCH_STAT(info, STAT_SINGULAR_SEARCHES);
             // All other moves failed low, so the move is singular
             if (value < rbeta) {
                 extensions = 1;
+                SEARCH_STAT(info, STAT_SINGULAR_EXTENSIONS);
             }
         } else {
             // Check Extension
-            if (inCheck && board.see(move) >= 0) {
+            if (inCheck && board.see_ge(move, 0)) {
                 extensions = 1;
             }
         }
 
         newDepth += extensions;
 
+        ss->continuationHistory = thread->continuationHistory.get(board.turn(), board.piecetype(from_sq(move)), to_sq(move));
+
         // Play the move on the board
         board.do_move(move);
 
-        info->currentMove[plies] = move;
+        ss->currentMove = move;
 
-        newPv.reset();
+        thread->pv.reset(plies + 1);
 
         // Report the current move searched at main thread after a fixed amount of time
         if (   rootNode
@@ -706,7 +926,7 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
             reductions += cutNode;
 
             // Decrease reduction for killer and counter moves since they are usually good moves and cause a quick fail high which reduces the tree size
-            reductions -= (move == thread->killers.first(plies) || move == thread->killers.second(plies) || move == picker.counterMove);
+            reductions -= (move == ss->killers[0] || move == ss->killers[1] || move == picker.counterMove);
 
             // Decrease reduction if we are in check since the position might be very dynamic
             reductions -= inCheck;
@@ -723,24 +943,28 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
         // Principal Variation Search
         // We do a null window search here because we only want to know if the current move can beat alpha.
         if (reductions) {
-            value = -search(-alpha - 1, -alpha, newDepth - reductions, plies + 1, true, board, info, newPv, pruning);
+            value = -search(-alpha - 1, -alpha, newDepth - reductions, ss + 1, true, board, info, pruning);
+            SEARCH_STAT(info, STAT_LMR_SEARCHES);
+            if (value > alpha) {
+                SEARCH_STAT(info, STAT_LMR_RESEARCHES);
+            }
         }
 
         // Do a full depth search if the value did beat alpha since we might have missed something
         if ((reductions && value > alpha) || (!reductions && (!pvNode || movesCount > 1))) {
-            value = -search(-alpha - 1, -alpha, newDepth, plies + 1, !cutNode, board, info, newPv, pruning);
+            value = -search(-alpha - 1, -alpha, newDepth, ss + 1, !cutNode, board, info, pruning);
         }
 
         if (pvNode && (movesCount == 1 || (value > alpha && (rootNode || value < beta)))) {
-            value = -search(-beta, -alpha, newDepth, plies + 1, false, board, info, newPv, pruning);
+            value = -search(-beta, -alpha, newDepth, ss + 1, false, board, info, pruning);
         }
 
         // Undo the move.
         board.undo_move();
 
         // Abort if the search has been stopped
-        if (Threads.has_stopped()) {
-            return VALUE_DRAW;
+        if (has_stopped(info)) {
+            return TRACE_EXIT(VALUE_DRAW, EXIT_STOPPED);
         }
 
         // If our last search increased found a higher value, assign it as the best value
@@ -751,11 +975,15 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
             if (value > alpha) {
                 alpha = value;
                 bestMove = move;
-                pv.update(bestMove, newPv);
+                thread->pv.update(plies, bestMove);
                 // If the value is above beta, we can expect this position will never occur because the opponent
                 // will probably avoid it because he already has a better option at a higher depth. We can stop searching
                 // this node.
                 if (value >= beta) {
+                    SEARCH_STAT(info, STAT_BETA_CUTOFFS);
+                    if (movesCount == 1) {
+                        SEARCH_STAT(info, STAT_FIRST_MOVE_CUTOFFS);
+                    }
                     break; // Beta cut-off
                 }
 
@@ -768,18 +996,21 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
     // If there are no legal moves, check if we are checkmate or if the position is drawn
     if (movesCount == 0) {
         if (excluded != MOVE_NONE) {
-            return alpha;
+            return TRACE_EXIT(alpha, EXIT_NO_MOVES);
         }
         if (inCheck) {
-            return get_mated_value(plies);
+            return TRACE_EXIT(get_mated_value(plies), EXIT_NO_MOVES);
         } else {
-            return VALUE_DRAW;
+            return TRACE_EXIT(VALUE_DRAW, EXIT_NO_MOVES);
         }
     }
 
-    // If we failed high, and the move is quiet, update the quiet move stats.
-    if (bestValue >= beta && !is_promotion(bestMove) && !board.is_capture(bestMove)) {
-        update_quiet_stats(thread, board, info, plies, depth, quietMoves, bestMove);
+    // If we failed high, update the quiet move stats if the move is quiet, and the capture stats
+    if (bestValue >= beta) {
+        if (!is_promotion(bestMove) && !board.is_capture(bestMove)) {
+            update_quiet_stats(thread, board, ss, depth, quietMoves, bestMove);
+        }
+        update_capture_stats(thread, board, depth, captureMoves, bestMove);
     }
 
     // Store the depth, value, evaluation, best move and bound in the transposition table
@@ -791,7 +1022,33 @@ static Value search(Value alpha, Value beta, Depth depth, Depth plies, bool cutN
 
     assert(bestValue > -VALUE_INFINITE && bestValue < VALUE_INFINITE);
 
-    return bestValue;
+    return TRACE_EXIT(bestValue, bestValue >= beta ? EXIT_BETA_CUTOFF : EXIT_SEARCHED);
+
+}
+
+// Print the search statistics with rates derived from them
+void print_search_stats(std::ostream& os, const SearchStats& stats) {
+
+    auto rate = [&](const SearchStat stat, const SearchStat total) {
+        std::stringstream ss;
+        if (stats[total]) {
+            ss << std::fixed << std::setprecision(2) << 100.0 * stats[stat] / stats[total] << "%";
+        }
+        return ss.str();
+    };
+
+    for (unsigned stat = 0; stat < STAT_COUNT; stat++) {
+        os << std::left << std::setw(24) << SearchStatNames[stat] << std::right << std::setw(16) << stats[stat] << std::endl;
+    }
+
+    os << std::endl;
+    os << std::left << std::setw(24) << "First move cutoff rate" << std::right << std::setw(16) << rate(STAT_FIRST_MOVE_CUTOFFS, STAT_BETA_CUTOFFS) << std::endl;
+    os << std::left << std::setw(24) << "Null move success rate" << std::right << std::setw(16) << rate(STAT_NULL_MOVE_CUTOFFS, STAT_NULL_MOVE_TRIES) << std::endl;
+    os << std::left << std::setw(24) << "LMR re-search rate" << std::right << std::setw(16) << rate(STAT_LMR_RESEARCHES, STAT_LMR_SEARCHES) << std::endl;
+    os << std::left << std::setw(24) << "Singular extension rate" << std::right << std::setw(16) << rate(STAT_SINGULAR_EXTENSIONS, STAT_SINGULAR_SEARCHES) << std::endl;
+    os << std::left << std::setw(24) << "Lazy eval skip rate" << std::right << std::setw(16) << rate(STAT_LAZY_EVAL_EXITS, STAT_LAZY_EVALS) << std::endl;
+    os << std::left << std::setw(24) << "Pawn table hit rate" << std::right << std::setw(16) << rate(STAT_PAWN_TABLE_HITS, STAT_PAWN_TABLE_PROBES) << std::endl;
+    os << std::left << std::setw(24) << "Eval cache hit rate" << std::right << std::setw(16) << rate(STAT_EVAL_CACHE_HITS, STAT_EVAL_CACHE_PROBES) << std::endl;
 
 }
 
@@ -801,9 +1058,8 @@ void Thread::search() {
     info.start = Clock::now();
     init_time_management(&info);
 
-    const bool isMainThread = get_index() == 0;
+    const bool isMainThread = get_index() == 0 && !info.independent;
 
-    PrincipalVariation pv;
     Move bestMove = MOVE_NONE;
     Value value, alpha, beta, delta;
     value = 0;
@@ -811,6 +1067,7 @@ void Thread::search() {
     beta  = VALUE_INFINITE;
 
     info.threadIndex  = get_index();
+    info.thread       = this;
     info.isMainThread = isMainThread;
 
     // Adjust multiPv to maximum number of legal moves in root position
@@ -823,7 +1080,7 @@ void Thread::search() {
     // at lower depths we fill up the transposition table, history table...
     // This enables us to search higher depths much quicker and also enables us to dynamically
     // stop the search if we are low on time while still having a move to play in the position
-    for (Depth depth = 1; depth <= info.limits.depth && !Threads.has_stopped(); depth++) {
+    for (Depth depth = 1; depth <= info.limits.depth && !has_stopped(&info); depth++) {
 
         info.depth = depth;
 
@@ -831,7 +1088,7 @@ void Thread::search() {
         // We search as many principal variations as specifified by the user
         // A variation always starts with a different root move, the best variation
         // will be first, the second best second, and so on
-        for (unsigned multiPv = 0; multiPv < info.limits.multiPv && !Threads.has_stopped(); multiPv++) {
+        for (unsigned multiPv = 0; multiPv < info.limits.multiPv && !has_stopped(&info); multiPv++) {
 
             board.reset_plies();
 
@@ -854,11 +1111,11 @@ void Thread::search() {
 
             while (true) {
 
-                pv.reset();
+                pv.reset(0);
 
-                value = ::search(alpha, beta, depth, 0, false, board, &info, pv, true);
+                value = ::search(alpha, beta, depth, stack.root(), false, board, &info, true);
 
-                if (Threads.has_stopped()) {
+                if (has_stopped(&info)) {
                     break;
                 }
 
@@ -892,7 +1149,7 @@ void Thread::search() {
 
                 // Send the principal variation
                 // Do not report incomplete searches
-                if (!Threads.has_stopped()) {
+                if (!has_stopped(&info)) {
                     UCI::send_pv(info, value, pv, Threads.get_nodes(), alpha, beta);
                 }
 
@@ -906,19 +1163,38 @@ void Thread::search() {
 
                 update_time_management(&info);
 
-                if (info.limits.time) {
+                if (info.limits.time && !Threads.is_pondering()) {
                     if (should_stop(info)) {
                         Threads.stop_searching();
                     }
                 }
 
+            } else if (info.independent && !has_stopped(&info) && pv.length() > 0) {
+
+                // Independent searches report the result of the last completed iteration
+                info.bestMove[depth] = pv.best();
+                info.completedDepth = depth;
+                info.completedPv.clear();
+                for (unsigned pvIndex = 0; pvIndex < pv.length(); pvIndex++) {
+                    info.completedPv.push_back(pv.get_move(pvIndex));
+                }
+
             }
 
         }
 
     }
 
+#ifdef SEARCH_TRACE
+    // Make the trace of this search complete on disk
+    trace.flush();
+#endif
+
     if (isMainThread) {
+        // While pondering or searching infinitely, the best move is only sent after ponderhit or stop
+        while ((Threads.is_pondering() || info.limits.infinite) && !Threads.has_stopped()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
         // Signal all other threads to stop searching
         Threads.stop_searching();
         // Print the best move found to the console
@@ -27,12 +27,15 @@
 #include <atomic>
 #include <chrono>
 #include <utility>
+#include <vector>
 
 #include "types.hpp"
 #include "board.hpp"
 #include "move.hpp"
 #include "movegen.hpp"
 
+class Thread;
+
 // Margins for delta/futility pruning and razoring
 static const Value DeltaMargin       = 100;
 static const Value RazorMargin       = 300;
@@ -48,21 +51,49 @@ enum NodeType {
 
 };
 
-// A principal variation. Holds a list of all moves played in the current sequence
+// Search statistics counters. They are only collected in builds with SEARCH_STATS defined
+// (make STATS=yes), otherwise the SEARCH_STAT macro compiles to nothing
+enum SearchStat : unsigned {
+
+    STAT_PV_NODES, STAT_CUT_NODES, STAT_ALL_NODES, STAT_QSEARCH_NODES,
+    STAT_BETA_CUTOFFS, STAT_FIRST_MOVE_CUTOFFS, STAT_TT_CUTOFFS,
+    STAT_NULL_MOVE_TRIES, STAT_NULL_MOVE_CUTOFFS, STAT_RAZORING, STAT_FUTILITY_PRUNES,
+    STAT_LMR_SEARCHES, STAT_LMR_RESEARCHES, STAT_SINGULAR_SEARCHES, STAT_SINGULAR_EXTENSIONS,
+    STAT_DELTA_PRUNES, STAT_SEE_PRUNES, STAT_LAZY_EVALS, STAT_LAZY_EVAL_EXITS,
+    STAT_PAWN_TABLE_PROBES, STAT_PAWN_TABLE_HITS, STAT_EVAL_CACHE_PROBES, STAT_EVAL_CACHE_HITS,
+    STAT_COUNT
+
+};
+
+typedef std::array<uint64_t, STAT_COUNT> SearchStats;
+
+extern const std::array<std::string, STAT_COUNT> SearchStatNames;
+
+#ifdef SEARCH_STATS
+#define SEARCH_STAT(info, stat) ((info)->stats[stat]++)
+#else
+#define SEARCH_STAT(info, stat) ((void)0)
+#endif
+
+// Triangular principal variation table. Row n holds the principal variation of the
+// node at ply n, built from its best move and the row of the child node at ply n + 1.
+// Search frames therefore do not need to carry and copy lines of their own
 class PrincipalVariation {
 
     private:
 
-        unsigned size = 0;
-        std::array<Move, DEPTH_MAX> line = { MOVE_NONE };
+        std::array<std::array<Move, DEPTH_MAX + 1>, DEPTH_MAX + 1> lines;
+        std::array<unsigned, DEPTH_MAX + 1> lengths = { 0 };
 
     public:
 
-        Move best() { assert(size > 0); return line[0]; }
-        Move get_move(const unsigned index) const { return line[index]; }
-        unsigned length() const { return size; }
-        void reset() { size = 0; }
-        void update(const Move bestMove, const PrincipalVariation& pv);
+        // Accessors for the principal variation of the root node
+        Move best() const { assert(lengths[0] > 0); return lines[0][0]; }
+        Move get_move(const unsigned index) const { return lines[0][index]; }
+        unsigned length() const { return lengths[0]; }
+
+        void reset(const Depth plies) { lengths[plies] = 0; }
+        void update(const Depth plies, const Move bestMove);
 
 };
 
@@ -71,6 +102,7 @@ class PrincipalVariation {
 struct SearchLimits {
 
     bool infinite = false;
+    bool ponder = false;
     unsigned multiPv = 1;
     Depth depth = DEPTH_MAX;
     uint64_t nodes = 0;
@@ -81,18 +113,33 @@ struct SearchLimits {
 
 };
 
+// Outcome of a search run by Thread::search_alone()
+struct SearchResult {
+
+    Move bestMove = MOVE_NONE;
+    Value value = VALUE_NONE;
+    Depth depth = 0;
+    uint64_t nodes = 0;
+    std::vector<Move> pv;
+
+};
+
 // Various search information variables; shows status of current search, current iteration,
-// killer moves, history, bestmove and currentMove at given depth, evaluations, time management and more
+// bestmove and value at given iteration depth, time management and more
 class SearchInfo {
 
     public:
         
         unsigned threadIndex;
+        Thread* thread = nullptr; // Thread running the search, its tables are used for evaluation
         bool isMainThread;
+        bool independent = false; // Searched alone by Thread::search_alone(), only stopped by its own limits
+        bool standalone = false; // Searched by a thread outside of the pool, which ignores the stop flag of the pool
+        std::atomic_bool stopped{false}; // Stop flag of an independent search, may be set from other threads
+        Depth completedDepth = 0; // Last completed iteration of an independent search
+        std::vector<Move> completedPv; // Principal variation of the last completed iteration
 
         std::array<Move, DEPTH_MAX> bestMove = { MOVE_NONE };
-        std::array<Move, DEPTH_MAX> currentMove = { MOVE_NONE };
-        std::array<Value, DEPTH_MAX> eval = { 0 };
         std::array<Value, DEPTH_MAX> value = { 0 };
 
         TimePoint start;
@@ -105,45 +152,19 @@ class SearchInfo {
         Duration idealTime = 0;
         Duration maxTime = 0;
 
-        unsigned hashTableHits = 0;
+        uint64_t hashTableHits = 0;
+        uint64_t hashTableProbes = 0;
         Depth depth = 0; // Absolute depth
         Depth selectiveDepth = 0; // Selective depth; so quiescent search depth is included
         std::atomic<uint64_t> nodes{0};
 
         int pvStability = 0;
 
-        void reset();
-
-};
-
-class KillerMoves {
-
-    public:
-        inline Move first(Depth plies) const {
-            return moves[plies].first;
-        }
-
-        inline Move second(Depth plies) const {
-            return moves[plies].second;
-        }
-
-        // Put the current first killer (if available) back to second killer and
-        // set the new move as first killer
-        inline void update(Depth plies, Move move) {
-            moves[plies].second = moves[plies].first;
-            moves[plies].first = move;
-        }
-
-        inline void clear(Depth plies) {
-            moves[plies] = std::make_pair(MOVE_NONE, MOVE_NONE);
-        }
-        
-        inline void clear() {
-            moves.fill(std::make_pair(MOVE_NONE, MOVE_NONE));
-        }
+#ifdef SEARCH_STATS
+        SearchStats stats = {};
+#endif
 
-    private:
-        std::array<std::pair<Move, Move>, DEPTH_MAX+1> moves;
+        void reset();
 
 };
 
@@ -164,6 +185,11 @@ class ButterflyTable {
 
 };
 
+// Formula for calculating new history score. The score is kept within [-16384, 16384]
+inline void update_history_score(int& score, int delta) {
+    score += 32 * delta - score * std::abs(delta) / 512;
+}
+
 class HistoryTable : public ButterflyTable<int> {
 
     public:
@@ -172,11 +198,70 @@ class HistoryTable : public ButterflyTable<int> {
         }
 
         inline void update_score(Color color, Piecetype type, Square square, int delta) {
-            const int currentScore = get_score(color, type, square);
-            // Formula for calculating new history score
-            values[color][type][square] += 32 * delta - currentScore * std::abs(delta) / 512; 
+            update_history_score(values[color][type][square], delta);
+        }
+
+};
+
+// History of the moves which followed a certain piece moving to a certain square
+typedef HistoryTable PieceToHistory;
+
+// Continuation history is indexed by the piece and destination square of an earlier move
+// and the piece and destination square of the current move. It is used for the moves one ply
+// and two plies back; since the color of the earlier piece differs between the two, they do
+// not share any entries.
+// The tables take several megabytes, so they are cleared lazily: clear() starts a new
+// generation and a table of an older generation is cleared when it is used the next time
+class ContinuationHistory {
+
+    public:
+        inline PieceToHistory* get(Color color, Piecetype type, Square square) {
+            if (generations[color][type][square] != generation) {
+                generations[color][type][square] = generation;
+                tables[color][type][square].clear();
+            }
+            return &tables[color][type][square];
+        }
+
+        // Table used when there is no earlier move (root, null move). Since no move is made
+        // by PIECE_NONE it is never updated and all of its scores stay zero
+        inline PieceToHistory* sentinel() {
+            return &tables[WHITE][PIECE_NONE][0];
         }
 
+        inline void clear() {
+            // Once the counter wraps around, old generation numbers become valid again
+            if (++generation == 0) {
+                std::fill_n(&generations[0][0][0], COLOR_COUNT * (PIECETYPE_COUNT + 1) * SQUARE_COUNT, 1u);
+            }
+        }
+
+    private:
+        PieceToHistory tables[COLOR_COUNT][PIECETYPE_COUNT+1][SQUARE_COUNT];
+        unsigned generations[COLOR_COUNT][PIECETYPE_COUNT+1][SQUARE_COUNT] = {};
+        unsigned generation = 0;
+
+};
+
+// History of captures, indexed by the moving piece, its destination square and the captured piecetype
+class CaptureHistoryTable {
+
+    public:
+        inline int get_score(Color color, Piecetype type, Square square, Piecetype captured) const {
+            return values[color][type][square][captured];
+        }
+
+        inline void update_score(Color color, Piecetype type, Square square, Piecetype captured, int delta) {
+            update_history_score(values[color][type][square][captured], delta);
+        }
+
+        inline void clear() {
+            std::fill_n(&values[0][0][0][0], COLOR_COUNT * (PIECETYPE_COUNT + 1) * SQUARE_COUNT * (PIECETYPE_COUNT + 1), 0);
+        }
+
+    private:
+        int values[COLOR_COUNT][PIECETYPE_COUNT+1][SQUARE_COUNT][PIECETYPE_COUNT+1] = {};
+
 };
 
 class CounterMoveTable : public ButterflyTable<Move> {
@@ -196,6 +281,56 @@ class CounterMoveTable : public ButterflyTable<Move> {
 
 };
 
+// Search state of a single ply. A node accesses the entry of its own ply through a pointer,
+// which makes the entries of the parent (ss - 1) and the child (ss + 1) directly available
+struct SearchStack {
+
+    Depth plies = 0;
+    Move currentMove = MOVE_NONE;
+    Move excludedMove = MOVE_NONE; // Move skipped in a singular extension search
+    Value staticEval = VALUE_NONE;
+    std::array<Move, 2> killers = { MOVE_NONE, MOVE_NONE };
+    PieceToHistory* continuationHistory = nullptr; // Continuation history of currentMove
+
+    // Put the current first killer (if available) back to second killer and
+    // set the new move as first killer
+    inline void update_killers(const Move move) {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+
+    inline void clear_killers() {
+        killers = { MOVE_NONE, MOVE_NONE };
+    }
+
+};
+
+// The search stack of a thread. Entries before the root node are sentinels,
+// so nodes near the root can access their ancestors without any checks
+class SearchStackArray {
+
+    public:
+
+        static constexpr int Offset = 2;
+
+        SearchStack* root() { return &entries[Offset]; }
+
+        inline void clear(PieceToHistory* sentinel) {
+            for (unsigned i = 0; i < entries.size(); i++) {
+                entries[i] = SearchStack();
+                entries[i].plies = int(i) - Offset;
+                entries[i].continuationHistory = sentinel;
+            }
+        }
+
+    private:
+
+        std::array<SearchStack, DEPTH_MAX + Offset + 2> entries;
+
+};
+
+extern void print_search_stats(std::ostream& os, const SearchStats& stats);
+
 namespace Search {
     extern void init();
 }
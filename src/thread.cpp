@@ -22,7 +22,9 @@
 */
 
 #include "thread.hpp"
+#include "movegen.hpp"
 #include "uci.hpp"
+#include "perfcounters.hpp"
 
 ThreadPool::ThreadPool(const unsigned count) {
 
@@ -50,11 +52,36 @@ void ThreadPool::resize(const unsigned count) {
         for (int i = 0; i < difference; i++) {
             unsigned threadIndex = get_thread_count();
             threads.push_back(new Thread(threadIndex));
+            threads.back()->pawnTable.set_size(PawnHashOption.get_value());
+            threads.back()->evalCache.set_size(EvalCacheOption.get_value());
+#ifdef SEARCH_TRACE
+            if (!traceFile.empty()) {
+                threads.back()->trace.open(traceFile + "." + std::to_string(threadIndex));
+            }
+#endif
         }
     }
 
 }
 
+// Resize the pawn hash tables of all threads
+void ThreadPool::set_pawn_table_size(const unsigned megabytes) {
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        threads[i]->pawnTable.set_size(megabytes);
+    }
+
+}
+
+// Resize the evaluation caches of all threads
+void ThreadPool::set_eval_cache_size(const unsigned megabytes) {
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        threads[i]->evalCache.set_size(megabytes);
+    }
+
+}
+
 // Reset all threads
 void ThreadPool::reset() {
 
@@ -69,6 +96,7 @@ void ThreadPool::initialize_search(const Board& board, const SearchLimits& limit
 
     // Reset stop flag and increase transposition table age
     stopped = false;
+    pondering = limits.ponder;
     TTable.new_search();
 
     for (unsigned i = 0; i < get_thread_count(); i++) {
@@ -89,6 +117,18 @@ void ThreadPool::start_searching() {
 
 }
 
+// Make every thread run the given job instead of a search. The threads can run their
+// own searches independently with Thread::search_alone() until the pool is stopped
+void ThreadPool::start_jobs(const std::function<void(Thread&)>& job) {
+
+    stopped = false;
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        threads[i]->start_job(job);
+    }
+
+}
+
 // Wait until every thread has finished searching
 void ThreadPool::wait_until_finished() {
 
@@ -111,14 +151,78 @@ uint64_t ThreadPool::get_nodes() {
 
 }
 
-// Create a new thread
-Thread::Thread(const unsigned threadIndex) {
+#ifdef SEARCH_TRACE
+// Start tracing the search of all threads into files named <filename>.<thread index>
+// or stop tracing if the filename is empty
+bool ThreadPool::set_trace(const std::string& filename) {
+
+    traceFile = filename;
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        if (filename.empty()) {
+            threads[i]->trace.close();
+        } else if (!threads[i]->trace.open(filename + "." + std::to_string(i))) {
+            traceFile.clear();
+            return false;
+        }
+    }
+
+    return true;
+
+}
+#endif
+
+// Calculate the cumulative number of transposition table hits across all threads
+uint64_t ThreadPool::get_hash_table_hits() {
+
+    uint64_t hits = 0;
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        hits += threads[i]->get_hash_table_hits();
+    }
+
+    return hits;
+
+}
+
+// Calculate the cumulative number of transposition table probes across all threads
+uint64_t ThreadPool::get_hash_table_probes() {
+
+    uint64_t probes = 0;
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        probes += threads[i]->get_hash_table_probes();
+    }
+
+    return probes;
+
+}
+
+// Sum up the search statistics of all threads
+SearchStats ThreadPool::get_search_stats() {
+
+    SearchStats stats = {};
+
+    for (unsigned i = 0; i < get_thread_count(); i++) {
+        const SearchStats threadStats = threads[i]->get_search_stats();
+        for (unsigned stat = 0; stat < STAT_COUNT; stat++) {
+            stats[stat] += threadStats[stat];
+        }
+    }
+
+    return stats;
+
+}
+
+// Create a new thread. Standalone threads are not part of the pool, see Engine
+Thread::Thread(const unsigned threadIndex, const bool isStandalone) {
 
     index = threadIndex;
+    standalone = isStandalone;
+    stack.clear(continuationHistory.sentinel());
 
     // The thread starts waiting in the thread pool for a search request
-    std::thread thread = std::thread(&Thread::idle, this);
-    thread.detach();
+    nativeThread = std::thread(&Thread::idle, this);
 
 }
 
@@ -126,29 +230,110 @@ Thread::Thread(const unsigned threadIndex) {
 void Thread::initialize(const Board& b, const SearchLimits& limits) {
 
     board = b;
+    board.refresh_accumulator();
+    board.refresh_attack_map();
     info.reset();
     info.limits = limits;
 
+#ifdef SEARCH_STATS
+    pawnTable.probes = pawnTable.hits = 0;
+    evalCache.probes = evalCache.hits = 0;
+#endif
+
     // TODO: This seems to positively affect strength - why??
-    killers.clear();
     history.clear();
+    captureHistory.clear();
+    continuationHistory.clear();
     counterMove.clear();
+    stack.clear(continuationHistory.sentinel());
 
 }
 
-// Reset board, killers, history, info and hash tables for thread
+// Search a position on the calling thread without involving the other threads of the pool.
+// The search only stops at its own limits or when the pool is stopped, and prints nothing
+SearchResult Thread::search_alone(const Board& b, const SearchLimits& limits) {
+
+    prepare_alone(b, limits);
+
+    return run_alone();
+
+}
+
+// Set up an independent search. An idle thread may be prepared by another thread
+// before it is started, so that a stop request can not get lost
+void Thread::prepare_alone(const Board& b, const SearchLimits& limits) {
+
+    initialize(b, limits);
+    info.independent = true;
+    info.standalone = standalone;
+
+}
+
+// Run a prepared independent search and return the result of its last completed iteration
+SearchResult Thread::run_alone() {
+
+    SearchResult result;
+
+    // Checkmate and stalemate have no iteration to complete
+    if (generate_moves<ALL, LEGAL>(board, board.turn()).size() == 0) {
+        result.value = board.checkers() ? -VALUE_MATE : VALUE_DRAW;
+        return result;
+    }
+
+    search();
+
+    result.bestMove = info.bestMove[info.completedDepth];
+    result.value    = info.value[info.completedDepth];
+    result.depth    = info.completedDepth;
+    result.nodes    = info.nodes;
+    result.pv       = info.completedPv;
+
+    return result;
+
+}
+
+// Reset board, search stack, histories, history, info and hash tables for thread
 void Thread::clear() {
 
     board = Board();
     pawnTable.clear();
-    materialTable.clear();
-    killers.clear();
+    evalCache.clear();
     history.clear();
+    captureHistory.clear();
+    continuationHistory.clear();
     counterMove.clear();
+    stack.clear(continuationHistory.sentinel());
     info.reset();
 
 }
 
+// Search statistics of the last search; always zero if they are not compiled in
+SearchStats Thread::get_search_stats() {
+
+#ifdef SEARCH_STATS
+    SearchStats stats = info.stats;
+    stats[STAT_PAWN_TABLE_PROBES] = pawnTable.probes;
+    stats[STAT_PAWN_TABLE_HITS] = pawnTable.hits;
+    stats[STAT_EVAL_CACHE_PROBES] = evalCache.probes;
+    stats[STAT_EVAL_CACHE_HITS] = evalCache.hits;
+    return stats;
+#else
+    return SearchStats();
+#endif
+
+}
+
+// Get the thread id of the operating system; waits until the thread has started
+long Thread::get_system_id() {
+
+    while (systemId == -1) {
+        std::this_thread::yield();
+    }
+
+    return systemId;
+
+}
+
 // Make the thread start searching
 void Thread::start() {
 
@@ -160,6 +345,14 @@ void Thread::start() {
 
 }
 
+// Wake up the thread and make it run a job instead of a search
+void Thread::start_job(const std::function<void(Thread&)>& j) {
+
+    job = j;
+    start();
+
+}
+
 // Called when the thread finished searching
 void Thread::stop() {
 
@@ -168,16 +361,23 @@ void Thread::stop() {
 
 }
 
-// Destroy this thread
+// Destroy this thread. Waits until the idle loop has exited, so the thread can be deleted afterwards
 void Thread::destroy() {
 
-    shouldExit = true;
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        shouldExit = true;
+    }
+
     cv.notify_one(); // Make thread in idle loop exit
+    nativeThread.join();
 
 }
 
 void Thread::idle() {
 
+    systemId = current_thread_id();
+
     while (true) {
 
         std::unique_lock<std::mutex> lck(mtx);
@@ -187,7 +387,12 @@ void Thread::idle() {
             return;
         }
 
-        search();
+        if (job) {
+            job(*this);
+            job = nullptr;
+        } else {
+            search();
+        }
 
         stop();
 
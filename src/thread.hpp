@@ -28,8 +28,10 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 
 #include "search.hpp"
+#include "trace.hpp"
 
 class Thread {
 
@@ -38,13 +40,20 @@ class Thread {
         Board board;
 
         PawnTable pawnTable;
-        MaterialTable materialTable;
+        EvalCache evalCache;
 
-        KillerMoves killers;
+        SearchStackArray stack;
         CounterMoveTable counterMove;
         HistoryTable history;
+        CaptureHistoryTable captureHistory;
+        ContinuationHistory continuationHistory;
+        PrincipalVariation pv;
 
-        explicit Thread(const unsigned threadIndex);
+#ifdef SEARCH_TRACE
+        TraceWriter trace;
+#endif
+
+        explicit Thread(const unsigned threadIndex, const bool isStandalone = false);
         Thread(const Thread&) = delete;
         Thread& operator=(const Thread&) = delete;
 
@@ -56,21 +65,36 @@ class Thread {
         void idle();
         void wait();
         void start();
+        void start_job(const std::function<void(Thread&)>& j);
         void stop();
         void search();
+        SearchResult search_alone(const Board& b, const SearchLimits& searchLimits);
+        void prepare_alone(const Board& b, const SearchLimits& searchLimits);
+        SearchResult run_alone();
+        void stop_alone() { info.stopped = true; }
         uint64_t get_nodes() { return info.nodes; };
+        long get_system_id();
+        uint64_t get_hash_table_hits() { return info.hashTableHits; }
+        uint64_t get_hash_table_probes() { return info.hashTableProbes; }
+        Depth get_selective_depth() { return info.selectiveDepth; }
+        SearchStats get_search_stats();
 
     private:
 
         unsigned index;
+        bool standalone = false; // Not part of the pool, searches are only stopped by stop_alone()
         bool isSearching = false;
         bool shouldExit = false;
+        std::atomic<long> systemId{-1}; // Thread id of the operating system, e.g. for performance counters
 
         std::mutex mtx;
         std::condition_variable cv;
+        std::thread nativeThread; // Runs the idle loop
         
         SearchInfo info;
 
+        std::function<void(Thread&)> job; // Run instead of a search if set, see start_job()
+
 };
 
 class ThreadPool {
@@ -82,19 +106,38 @@ class ThreadPool {
 
         explicit ThreadPool(const unsigned count);
         void resize(const unsigned threadCount);
+        void set_pawn_table_size(const unsigned megabytes);
+        void set_eval_cache_size(const unsigned megabytes);
         void reset();
         void initialize_search(const Board& board, const SearchLimits& limits);
         void start_searching();
+        void start_jobs(const std::function<void(Thread&)>& job);
         void stop_searching() { stopped = true; }
+        void ponderhit() { pondering = false; }
+        bool is_pondering() { return pondering; }
         void wait_until_finished();
         bool has_stopped() { return stopped; }
+        bool is_silent() { return silent; }
+        void set_silent(const bool s) { silent = s; }
         uint64_t get_nodes();
+#ifdef SEARCH_TRACE
+        bool set_trace(const std::string& filename);
+#endif
+        uint64_t get_hash_table_hits();
+        uint64_t get_hash_table_probes();
+        SearchStats get_search_stats();
 
     private:
     
         std::vector<Thread*> threads;
 
         std::atomic_bool stopped = true;
+        std::atomic_bool pondering = false; // Time limits are ignored until ponderhit
+        bool silent = false; // Suppress search output, e.g. for machine-readable benchmarks
+
+#ifdef SEARCH_TRACE
+        std::string traceFile; // Every thread writes to its own file with the thread index appended
+#endif
 
 };
 
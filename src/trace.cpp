@@ -0,0 +1,170 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#include "trace.hpp"
+#include "move.hpp"
+
+static const std::string NodeTypeNames[TRACE_NODE_TYPE_COUNT] = {
+    "PV", "Cut", "All", "QS"
+};
+
+static const std::string ExitNames[EXIT_COUNT] = {
+    "Searched", "Beta cutoff", "Stopped", "Draw", "Max ply",
+    "Mate distance", "TT cutoff", "Stand pat", "Razoring",
+    "Null move", "No moves"
+};
+
+bool TraceWriter::open(const std::string& filename) {
+
+    close();
+
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    buffer.reserve(BufferSize);
+
+    return file.is_open();
+
+}
+
+void TraceWriter::close() {
+
+    if (file.is_open()) {
+        flush();
+        file.close();
+    }
+
+}
+
+void TraceWriter::flush() {
+
+    if (file.is_open() && !buffer.empty()) {
+        file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(TraceRecord));
+        file.flush();
+    }
+
+    buffer.clear();
+
+}
+
+// Aggregated subtree sizes of a single ply
+struct PlySummary {
+
+    uint64_t records = 0;
+    uint64_t subtreeNodes = 0;
+    uint64_t types[TRACE_NODE_TYPE_COUNT] = {};
+    uint64_t exits[EXIT_COUNT] = {};
+
+};
+
+// Reads a trace file and prints how many nodes were spent at every ply, how nodes
+// were left and which moves up to the given ply had the largest subtrees
+void analyze_trace(const std::string& filename, const unsigned maxPly, std::ostream& os) {
+
+    std::ifstream file(filename, std::ios::binary);
+
+    if (!file.is_open()) {
+        os << "info string Error: could not open trace file " << filename << std::endl;
+        return;
+    }
+
+    std::vector<PlySummary> plies;
+    std::vector<std::map<Move, uint64_t>> moves(maxPly + 1);
+    uint64_t exits[EXIT_COUNT] = {};
+    uint64_t records = 0;
+
+    TraceRecord record;
+
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+
+        if (record.type >= TRACE_NODE_TYPE_COUNT || record.exit >= EXIT_COUNT) {
+            os << "info string Error: invalid trace record " << records << std::endl;
+            return;
+        }
+
+        if (record.ply >= plies.size()) {
+            plies.resize(record.ply + 1);
+        }
+
+        PlySummary& summary = plies[record.ply];
+        summary.records++;
+        summary.subtreeNodes += record.subtreeNodes;
+        summary.types[record.type]++;
+        summary.exits[record.exit]++;
+
+        if (record.ply > 0 && record.ply <= maxPly) {
+            moves[record.ply][record.move] += record.subtreeNodes;
+        }
+
+        exits[record.exit]++;
+        records++;
+
+    }
+
+    os << "Records: " << records << std::endl << std::endl;
+
+    os << std::setw(4) << "Ply" << std::setw(12) << "Nodes" << std::setw(16) << "Subtree nodes" << std::setw(12) << "Avg. size";
+    for (unsigned type = 0; type < TRACE_NODE_TYPE_COUNT; type++) {
+        os << std::setw(10) << NodeTypeNames[type];
+    }
+    os << std::setw(10) << "TT cut" << std::setw(10) << "Beta cut" << std::endl;
+
+    for (unsigned ply = 0; ply < plies.size(); ply++) {
+        const PlySummary& summary = plies[ply];
+        os << std::setw(4)  << ply
+           << std::setw(12) << summary.records
+           << std::setw(16) << summary.subtreeNodes
+           << std::setw(12) << std::fixed << std::setprecision(1) << (summary.records ? double(summary.subtreeNodes) / summary.records : 0.0);
+        for (unsigned type = 0; type < TRACE_NODE_TYPE_COUNT; type++) {
+            os << std::setw(10) << summary.types[type];
+        }
+        os << std::setw(10) << summary.exits[EXIT_TT_CUTOFF] << std::setw(10) << summary.exits[EXIT_BETA_CUTOFF] << std::endl;
+    }
+
+    os << std::endl << std::left << std::setw(16) << "Exit" << std::right << std::setw(12) << "Nodes" << std::setw(10) << "Share" << std::endl;
+
+    for (unsigned exit = 0; exit < EXIT_COUNT; exit++) {
+        os << std::left << std::setw(16) << ExitNames[exit] << std::right
+           << std::setw(12) << exits[exit]
+           << std::setw(9) << std::fixed << std::setprecision(2) << (records ? 100.0 * exits[exit] / records : 0.0) << "%" << std::endl;
+    }
+
+    // Moves with the largest subtrees, summed over all iterations
+    for (unsigned ply = 1; ply <= maxPly && ply < plies.size(); ply++) {
+
+        std::vector<std::pair<Move, uint64_t>> sorted(moves[ply].begin(), moves[ply].end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+
+        os << std::endl << "Largest subtrees at ply " << ply << std::endl;
+
+        for (unsigned i = 0; i < std::min<size_t>(sorted.size(), 10); i++) {
+            os << std::setw(8) << (sorted[i].first != MOVE_NONE ? move_to_string(sorted[i].first) : "null")
+               << std::setw(16) << sorted[i].second
+               << std::setw(9) << std::fixed << std::setprecision(2) << (plies[ply].subtreeNodes ? 100.0 * sorted[i].second / plies[ply].subtreeNodes : 0.0) << "%" << std::endl;
+        }
+
+    }
+
+}
@@ -0,0 +1,105 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+
+// Search tree tracing. In builds with SEARCH_TRACE defined (make TRACE=yes) the
+// search writes a compact binary record for every node it leaves to a file per
+// thread. Records are written in post-order, so every record knows the size of
+// the subtree below it. The files can be aggregated with analyze_trace()
+
+// Type of a traced node
+enum TraceNodeType : uint8_t {
+
+    TRACE_PV, TRACE_CUT, TRACE_ALL, TRACE_QSEARCH,
+    TRACE_NODE_TYPE_COUNT
+
+};
+
+// The reason why a node was left
+enum TraceExit : uint8_t {
+
+    EXIT_SEARCHED, EXIT_BETA_CUTOFF, EXIT_STOPPED, EXIT_DRAW, EXIT_MAX_PLY,
+    EXIT_MATE_DISTANCE, EXIT_TT_CUTOFF, EXIT_STAND_PAT, EXIT_RAZORING,
+    EXIT_NULL_MOVE, EXIT_NO_MOVES,
+    EXIT_COUNT
+
+};
+
+struct TraceRecord {
+
+    uint32_t subtreeNodes; // Nodes visited in this node and below, saturated
+    Move move; // Move leading to this node
+    int16_t alpha;
+    int16_t beta;
+    int16_t result;
+    uint8_t ply;
+    int8_t depth;
+    TraceNodeType type;
+    TraceExit exit;
+
+};
+
+static_assert(sizeof(TraceRecord) == 16, "Trace records should be tightly packed");
+
+// Buffered binary writer for the trace records of a single thread
+class TraceWriter {
+
+    public:
+
+        TraceWriter() = default;
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+        ~TraceWriter() { close(); }
+
+        bool open(const std::string& filename);
+        void close();
+        void flush();
+        bool is_open() const { return file.is_open(); }
+
+        inline void write(const TraceRecord& record) {
+            buffer.push_back(record);
+            if (buffer.size() == BufferSize) {
+                flush();
+            }
+        }
+
+    private:
+
+        static constexpr unsigned BufferSize = 1 << 16;
+
+        std::ofstream file;
+        std::vector<TraceRecord> buffer;
+
+};
+
+extern void analyze_trace(const std::string& filename, const unsigned maxPly, std::ostream& os);
+
+#endif
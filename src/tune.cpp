@@ -0,0 +1,487 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "tune.hpp"
+
+#ifdef EVAL_TUNE
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "io.hpp"
+#include "uci.hpp"
+
+namespace Tune {
+
+    // Run the function with the indices 0 to threadCount - 1, each on its own thread
+    template <typename Function>
+    static void parallel_for(const unsigned threadCount, Function function) {
+
+        std::vector<std::thread> workers;
+
+        for (unsigned index = 1; index < threadCount; index++) {
+            workers.emplace_back(function, index);
+        }
+
+        function(0);
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+    }
+
+    // The king safety of a color depends on its king danger like in evaluate_king_safety()
+    static inline void king_safety(const float safety[2], const double danger, double value[2], double slope[2]) {
+
+        value[MG] = safety[MG];
+        value[EG] = safety[EG];
+        slope[MG] = slope[EG] = 0;
+
+        if (danger > 0) {
+            value[MG] -= danger * danger / 2048;
+            value[EG] -= danger / 16;
+            slope[MG]  = -danger / 1024;
+            slope[EG]  = -1.0 / 16;
+        }
+
+        if (value[MG] > 80) {
+            value[MG] = 80;
+            slope[MG] = 0;
+        }
+
+    }
+
+    // Compute the unscaled evaluation of an entry and the derivative of the scaled
+    // evaluation with respect to the king danger of each color
+    static inline void evaluate_entry(const Entry& entry, const Coefficient* coefficients, const Parameters& parameters, double value[2], double dangerSlope[2]) {
+
+        double danger[2] = { entry.danger[WHITE], entry.danger[BLACK] };
+
+        value[MG] = entry.base[MG];
+        value[EG] = entry.base[EG];
+
+        for (unsigned i = 0; i < entry.count; i++) {
+            const Coefficient& coefficient = coefficients[entry.first + i];
+            if (coefficient.index < TUNE_TERM_COUNT) {
+                value[MG] += coefficient.value * parameters.terms[coefficient.index][MG];
+                value[EG] += coefficient.value * parameters.terms[coefficient.index][EG];
+            } else {
+                const unsigned index = coefficient.index - TUNE_TERM_COUNT;
+                danger[index / DANGER_WEIGHT_COUNT] += coefficient.value * parameters.weights[index % DANGER_WEIGHT_COUNT];
+            }
+        }
+
+        for (Color color = WHITE; color <= BLACK; ++color) {
+            const int sign = color == WHITE ? 1 : -1;
+            double safety[2], slope[2];
+            king_safety(entry.safety[color], danger[color], safety, slope);
+            value[MG] += sign * safety[MG];
+            value[EG] += sign * safety[EG];
+            dangerSlope[color] = sign * (slope[MG] * entry.mgFactor + slope[EG] * entry.egFactor);
+        }
+
+    }
+
+    // Win probability for a scaled evaluation in centipawns
+    static inline double sigmoid(const double scaling, const double eval) {
+
+        return 1.0 / (1.0 + std::exp(-scaling * eval * std::log(10.0) / 400.0));
+
+    }
+
+    // Trace all positions of the dataset, split into one shard per thread. Positions which
+    // are not evaluated by the handcrafted terms are skipped
+    uint64_t Tuner::load(const Dataset::Reader& dataset, const unsigned threadCount) {
+
+        EvalTerm terms[TUNE_TERM_COUNT];
+        int weights[DANGER_WEIGHT_COUNT];
+
+        Eval::tune_parameters(terms, weights);
+
+        for (unsigned i = 0; i < TUNE_TERM_COUNT; i++) {
+            initial.terms[i][MG] = terms[i].mg();
+            initial.terms[i][EG] = terms[i].eg();
+        }
+
+        for (unsigned j = 0; j < DANGER_WEIGHT_COUNT; j++) {
+            initial.weights[j] = weights[j];
+        }
+
+        current = initial;
+
+        shards.assign(threadCount, Shard());
+
+        parallel_for(threadCount, [&](const unsigned index) {
+
+            Shard& shard = shards[index];
+            Board board;
+            EvalTrace trace;
+
+            const uint64_t begin = dataset.size() * index / threadCount;
+            const uint64_t end   = dataset.size() * (index + 1) / threadCount;
+
+            shard.entries.reserve(end - begin);
+
+            for (uint64_t i = begin; i < end; i++) {
+
+                const PackedPosition& position = dataset[i];
+
+                if (   position.result >= Dataset::RESULT_COUNT
+                    || !board.from_packed(position)
+                    || !Eval::trace(board, trace))
+                {
+                    continue;
+                }
+
+                Entry entry;
+                entry.result   = position.result / 2.0f;
+                entry.mgFactor = trace.phase / float(PHASE_MIDGAME);
+                entry.egFactor = (PHASE_MIDGAME - trace.phase) * trace.scaleFactor / float(PHASE_MIDGAME * SCALE_FACTOR_NORMAL);
+                entry.first    = shard.coefficients.size();
+
+                for (unsigned term = 0; term < TUNE_TERM_COUNT; term++) {
+                    const int value = trace.terms[WHITE][term] - trace.terms[BLACK][term];
+                    if (value) {
+                        shard.coefficients.push_back({ uint16_t(term), int16_t(value) });
+                    }
+                }
+
+                for (Color color = WHITE; color <= BLACK; ++color) {
+
+                    int danger = trace.kingDanger[color];
+
+                    for (unsigned weight = 0; weight < DANGER_WEIGHT_COUNT; weight++) {
+                        const int value = trace.danger[color][weight];
+                        if (value) {
+                            shard.coefficients.push_back({ uint16_t(TUNE_TERM_COUNT + color * DANGER_WEIGHT_COUNT + weight), int16_t(value) });
+                            danger -= value * int(initial.weights[weight]);
+                        }
+                    }
+
+                    // Undo the danger part of the traced king safety
+                    const int kingDanger = trace.kingDanger[color];
+                    entry.danger[color]     = danger;
+                    entry.safety[color][MG] = trace.kingSafety[color].mg() + (kingDanger > 0 ? kingDanger * kingDanger / 2048 : 0);
+                    entry.safety[color][EG] = trace.kingSafety[color].eg() + (kingDanger > 0 ? kingDanger / 16 : 0);
+
+                }
+
+                entry.count = shard.coefficients.size() - entry.first;
+
+                // The constant part is whatever the parameters do not explain
+                double value[2], dangerSlope[2];
+                entry.base[MG] = entry.base[EG] = 0;
+                evaluate_entry(entry, shard.coefficients.data(), initial, value, dangerSlope);
+                entry.base[MG] = trace.value.mg() - value[MG];
+                entry.base[EG] = trace.value.eg() - value[EG];
+
+                shard.entries.push_back(entry);
+
+            }
+
+        });
+
+        positions = 0;
+        for (const Shard& shard : shards) {
+            positions += shard.entries.size();
+        }
+
+        return positions;
+
+    }
+
+    // Scaled evaluation of an entry from white's point of view
+    double Tuner::evaluate(const unsigned shard, const unsigned index, const Parameters& parameters) const {
+
+        const Entry& entry = shards[shard].entries[index];
+        double value[2], dangerSlope[2];
+
+        evaluate_entry(entry, shards[shard].coefficients.data(), parameters, value, dangerSlope);
+
+        return value[MG] * entry.mgFactor + value[EG] * entry.egFactor;
+
+    }
+
+    // Mean squared error between the predicted and the actual game results
+    double Tuner::loss(const Parameters& parameters) const {
+
+        std::vector<double> sums(shards.size());
+
+        parallel_for(shards.size(), [&](const unsigned index) {
+
+            const Shard& shard = shards[index];
+            double sum = 0;
+
+            for (const Entry& entry : shard.entries) {
+                double value[2], dangerSlope[2];
+                evaluate_entry(entry, shard.coefficients.data(), parameters, value, dangerSlope);
+                const double error = entry.result - sigmoid(scaling, value[MG] * entry.mgFactor + value[EG] * entry.egFactor);
+                sum += error * error;
+            }
+
+            sums[index] = sum;
+
+        });
+
+        double sum = 0;
+        for (const double shardSum : sums) {
+            sum += shardSum;
+        }
+
+        return positions ? sum / positions : 0;
+
+    }
+
+    // Find the scaling of the sigmoid which best fits the evaluations with the current parameters to the results
+    double Tuner::fit_scaling() {
+
+        double best = scaling;
+        double bestLoss = loss(current);
+
+        for (double step = 0.1; step > 0.0005; step /= 10) {
+            const double center = best;
+            for (int i = -10; i <= 10; i++) {
+                scaling = center + i * step;
+                if (scaling <= 0) {
+                    continue;
+                }
+                const double value = loss(current);
+                if (value < bestLoss) {
+                    bestLoss = value;
+                    best = scaling;
+                }
+            }
+        }
+
+        scaling = best;
+
+        return scaling;
+
+    }
+
+    // Gradient of the loss with respect to all parameters
+    void Tuner::gradient(const Parameters& parameters, Parameters& result) const {
+
+        std::vector<Parameters> gradients(shards.size());
+
+        parallel_for(shards.size(), [&](const unsigned index) {
+
+            const Shard& shard = shards[index];
+            Parameters& gradient = gradients[index];
+
+            std::memset(&gradient, 0, sizeof(Parameters));
+
+            for (const Entry& entry : shard.entries) {
+
+                double value[2], dangerSlope[2];
+                evaluate_entry(entry, shard.coefficients.data(), parameters, value, dangerSlope);
+
+                const double probability = sigmoid(scaling, value[MG] * entry.mgFactor + value[EG] * entry.egFactor);
+                const double slope = (probability - entry.result) * probability * (1 - probability);
+
+                for (unsigned i = 0; i < entry.count; i++) {
+                    const Coefficient& coefficient = shard.coefficients[entry.first + i];
+                    if (coefficient.index < TUNE_TERM_COUNT) {
+                        gradient.terms[coefficient.index][MG] += slope * coefficient.value * entry.mgFactor;
+                        gradient.terms[coefficient.index][EG] += slope * coefficient.value * entry.egFactor;
+                    } else {
+                        const unsigned weight = coefficient.index - TUNE_TERM_COUNT;
+                        gradient.weights[weight % DANGER_WEIGHT_COUNT] += slope * coefficient.value * dangerSlope[weight / DANGER_WEIGHT_COUNT];
+                    }
+                }
+
+            }
+
+        });
+
+        // Constant factors of the derivative of the mean squared error
+        const double factor = positions ? 2.0 * scaling * std::log(10.0) / 400.0 / positions : 0;
+
+        std::memset(&result, 0, sizeof(Parameters));
+
+        for (const Parameters& gradient : gradients) {
+            for (unsigned i = 0; i < TUNE_TERM_COUNT; i++) {
+                result.terms[i][MG] += factor * gradient.terms[i][MG];
+                result.terms[i][EG] += factor * gradient.terms[i][EG];
+            }
+            for (unsigned j = 0; j < DANGER_WEIGHT_COUNT; j++) {
+                result.weights[j] += factor * gradient.weights[j];
+            }
+        }
+
+    }
+
+    // Optimize the parameters with Adam, a gradient descent with per-parameter step sizes
+    void Tuner::run(const unsigned iterations, const double learningRate, std::ostream& os) {
+
+        constexpr double Beta1 = 0.9, Beta2 = 0.999, Epsilon = 1e-8;
+        constexpr unsigned Count = sizeof(Parameters) / sizeof(double);
+
+        Parameters gradient, moment, velocity;
+        std::memset(&moment, 0, sizeof(Parameters));
+        std::memset(&velocity, 0, sizeof(Parameters));
+
+        double* values     = reinterpret_cast<double*>(&current);
+        double* gradients  = reinterpret_cast<double*>(&gradient);
+        double* moments    = reinterpret_cast<double*>(&moment);
+        double* velocities = reinterpret_cast<double*>(&velocity);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (unsigned iteration = 1; iteration <= iterations; iteration++) {
+
+            this->gradient(current, gradient);
+
+            const double momentCorrection   = 1 - std::pow(Beta1, iteration);
+            const double velocityCorrection = 1 - std::pow(Beta2, iteration);
+
+            for (unsigned i = 0; i < Count; i++) {
+                moments[i]    = Beta1 * moments[i]    + (1 - Beta1) * gradients[i];
+                velocities[i] = Beta2 * velocities[i] + (1 - Beta2) * gradients[i] * gradients[i];
+                const double correctedMoment   = moments[i]    / momentCorrection;
+                const double correctedVelocity = velocities[i] / velocityCorrection;
+                values[i] -= learningRate * correctedMoment / (std::sqrt(correctedVelocity) + Epsilon);
+            }
+
+            if (iteration % 50 == 0 || iteration == iterations) {
+                os << "Iteration " << std::setw(6) << iteration << "  Loss " << std::fixed << std::setprecision(8) << loss(current) << std::endl;
+            }
+
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (seconds > 0) {
+            os << "Gradient throughput: " << uint64_t(double(positions) * iterations / seconds / shards.size()) << " positions/s per thread" << std::endl;
+        }
+
+    }
+
+    static std::string format_term(const double mg, const double eg) {
+
+        std::ostringstream ss;
+        ss << "V(" << std::setw(4) << std::lround(mg) << ", " << std::setw(4) << std::lround(eg) << ")";
+
+        return ss.str();
+
+    }
+
+    // Print the current parameters in the format of the evaluation source
+    void Tuner::print(std::ostream& os) const {
+
+        static const std::string PieceNames[6] = { "Pawns", "Knights", "Bishops", "Rooks", "Queens", "King" };
+        static const unsigned MobilityCounts[4] = { 9, 14, 15, 28 };
+        static const std::string WeightNames[DANGER_ATTACKER] = {
+            "kingNoQueenAttacker", "queenSafeCheckWeight", "rookSafeCheckWeight", "bishopSafeCheckWeight",
+            "knightSafeCheckWeight", "kingUnsafeCheck", "kingRingAttackWeight", "kingRingWeakSquareAttack",
+            "kingSliderBlocker", "kingKnightDefender", "kingBishopDefender"
+        };
+
+        os << "static constexpr EvalTerm Material[6] = {" << std::endl << std::endl;
+        for (unsigned pt = PAWN; pt < KING; pt++) {
+            os << "    " << format_term(current.terms[TUNE_MATERIAL + pt][MG], current.terms[TUNE_MATERIAL + pt][EG]) << "," << std::endl;
+        }
+        os << "    " << format_term(0, 0) << std::endl << std::endl << "};" << std::endl << std::endl;
+
+        os << "static constexpr EvalTerm PstValues[6][32] = {" << std::endl << std::endl;
+        for (unsigned pt = PAWN; pt <= KING; pt++) {
+            os << "    // " << PieceNames[pt] << std::endl << "    {" << std::endl << std::endl;
+            for (unsigned r = 0; r < 8; r++) {
+                os << "       ";
+                for (unsigned f = 0; f < 4; f++) {
+                    const double* term = current.terms[TUNE_PST + pt * 32 + 4 * r + f];
+                    os << " " << format_term(term[MG], term[EG]) << ",";
+                }
+                os << std::endl;
+            }
+            os << std::endl << "    }" << (pt < KING ? "," : "") << std::endl;
+        }
+        os << std::endl << "};" << std::endl << std::endl;
+
+        os << "static constexpr EvalTerm Mobility[4][28] = {" << std::endl << std::endl;
+        for (unsigned type = 0; type < 4; type++) {
+            os << "    // " << PieceNames[KNIGHT + type] << std::endl << "    {";
+            for (unsigned mobility = 0; mobility < MobilityCounts[type]; mobility++) {
+                const double* term = current.terms[TUNE_MOBILITY + type * 28 + mobility];
+                os << (mobility ? ", " : " ") << format_term(term[MG], term[EG]);
+            }
+            os << " }" << (type < 3 ? "," : "") << std::endl;
+        }
+        os << std::endl << "};" << std::endl << std::endl;
+
+        for (unsigned weight = 0; weight < DANGER_ATTACKER; weight++) {
+            os << "static const unsigned " << std::left << std::setw(24) << WeightNames[weight] << std::right << " = " << std::setw(3) << std::lround(current.weights[weight]) << ";" << std::endl;
+        }
+        os << "static const unsigned attackerWeight[5]          = { 0";
+        for (unsigned weight = DANGER_ATTACKER; weight < DANGER_WEIGHT_COUNT; weight++) {
+            os << ", " << std::lround(current.weights[weight]);
+        }
+        os << " };" << std::endl;
+
+    }
+
+    // Tune the evaluation on a dataset file and print the tuned parameters
+    void tune(const std::string& filename, const unsigned iterations, const unsigned threadCount, const double learningRate) {
+
+        Dataset::Reader dataset;
+
+        if (!dataset.open(filename)) {
+            UCI::send_string("Error: could not open dataset " + filename);
+            return;
+        }
+
+        Tuner tuner;
+
+        auto start = std::chrono::steady_clock::now();
+        tuner.load(dataset, threadCount);
+        const double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // The tuning progress is written directly, after any lines still in the output queue
+        IO::flush();
+
+        std::cout << "Traced " << tuner.size() << " of " << dataset.size() << " positions in " << std::fixed << std::setprecision(2) << loadSeconds << "s ("
+                  << uint64_t(tuner.size() / std::max(loadSeconds, 1e-6) / threadCount) << " positions/s per thread)" << std::endl;
+
+        if (!tuner.size()) {
+            return;
+        }
+
+        const double scaling = tuner.fit_scaling();
+        std::cout << "Scaling " << std::setprecision(3) << scaling << "  Loss " << std::setprecision(8) << tuner.loss(tuner.parameters()) << std::endl;
+
+        tuner.run(iterations, learningRate, std::cout);
+
+        std::cout << std::endl;
+        tuner.print(std::cout);
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#ifndef TUNE_H
+#define TUNE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "evaluate.hpp"
+#include "dataset.hpp"
+
+#ifdef EVAL_TUNE
+
+// Offline tuning of the evaluation (make TUNE=yes). Every position of a dataset is evaluated
+// once into a linearized trace of the tunable terms. The parameters are then optimized with
+// gradient descent on the error between the predicted and the actual game results, where the
+// prediction is computed from the traces alone
+
+namespace Tune {
+
+    enum { MG, EG };
+
+    struct Parameters {
+
+        double terms[TUNE_TERM_COUNT][2];
+        double weights[DANGER_WEIGHT_COUNT];
+
+    };
+
+    // Coefficient of a term (white minus black count) or of a danger weight of one color
+    // (index TUNE_TERM_COUNT + color * DANGER_WEIGHT_COUNT + weight)
+    struct Coefficient {
+
+        uint16_t index;
+        int16_t value;
+
+    };
+
+    // A position reduced to the coefficients of the parameters and the constant part of its evaluation
+    struct Entry {
+
+        float result; // 0, 0.5 or 1 from white's point of view
+        float mgFactor; // Share of the midgame and endgame values in the scaled evaluation
+        float egFactor;
+        float base[2]; // Constant midgame and endgame value
+        float danger[2]; // Constant part of the king danger of each color
+        float safety[2][2]; // King safety of each color without the danger
+        uint32_t first; // Range of the coefficients
+        uint32_t count;
+
+    };
+
+    class Tuner {
+
+        public:
+
+            uint64_t load(const Dataset::Reader& dataset, const unsigned threadCount);
+            double fit_scaling();
+            double loss(const Parameters& parameters) const;
+            double evaluate(const unsigned shard, const unsigned index, const Parameters& parameters) const;
+            void run(const unsigned iterations, const double learningRate, std::ostream& os);
+            void print(std::ostream& os) const;
+
+            inline uint64_t size() const { return positions; }
+            inline const Parameters& parameters() const { return current; }
+
+        private:
+
+            struct Shard {
+
+                std::vector<Entry> entries;
+                std::vector<Coefficient> coefficients;
+
+            };
+
+            void gradient(const Parameters& parameters, Parameters& result) const;
+
+            std::vector<Shard> shards; // One per thread
+            Parameters initial;
+            Parameters current;
+            double scaling = 1.0;
+            uint64_t positions = 0;
+
+    };
+
+    extern void tune(const std::string& filename, const unsigned iterations, const unsigned threadCount, const double learningRate);
+
+}
+
+#endif
+
+#endif
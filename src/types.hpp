@@ -159,12 +159,31 @@ constexpr Value VALUE_MATE_MAX  =  VALUE_MATE - DEPTH_MAX;
 constexpr Value VALUE_MATED_MAX = -VALUE_MATE + DEPTH_MAX;
 constexpr Value VALUE_DRAW      = 0;
 
+// Moves until mate for a mate value, negative if the side to move gets mated
+constexpr int mate_distance(const Value value) {
+    return (value > 0 ? VALUE_MATE - value + 1 : -VALUE_MATE - value) / 2;
+}
+
 // EvalTerm structure
-// Consists of a value for the midgame and one for the endgame
+// Consists of a value for the midgame and one for the endgame, packed into a single integer with
+// the endgame value in the upper and the midgame value in the lower 16 bits. This way both values
+// are added, subtracted and multiplied at once. A negative midgame value borrows one from the
+// endgame value, which is undone when the endgame value is extracted
 struct EvalTerm {
 
-    int mg = 0;
-    int eg = 0;
+    int packed = 0;
+
+    constexpr EvalTerm() = default;
+    constexpr EvalTerm(const int mg, const int eg) : packed(int(unsigned(eg) << 16) + mg) {}
+
+    constexpr int mg() const { return int16_t(uint16_t(unsigned(packed))); }
+    constexpr int eg() const { return int16_t(uint16_t((unsigned(packed) + 0x8000) >> 16)); }
+
+    static constexpr EvalTerm from_packed(const int packed) {
+        EvalTerm value;
+        value.packed = packed;
+        return value;
+    }
 
 };
 
@@ -405,78 +424,62 @@ inline Bitboard shift_right(const Bitboard b, const Color color) {
 
 }
 
-inline EvalTerm V(const Value mg, const Value eg) {
+// Both values must fit into 16 bits
+constexpr EvalTerm V(const Value mg, const Value eg) {
 
-    EvalTerm value;
+    assert(mg >= INT16_MIN && mg <= INT16_MAX && eg >= INT16_MIN && eg <= INT16_MAX);
 
-    value.mg = mg;
-    value.eg = eg;
-
-    return value;
+    return EvalTerm(mg, eg);
 
 }
 
-inline bool operator==(const EvalTerm& value1, const EvalTerm& value2) {
-    return value1.mg == value2.mg && value1.eg == value2.eg;
+constexpr bool operator==(const EvalTerm value1, const EvalTerm value2) {
+    return value1.packed == value2.packed;
 }
 
-inline EvalTerm operator+=(EvalTerm& value, const EvalTerm value2) {
+constexpr EvalTerm operator+=(EvalTerm& value, const EvalTerm value2) {
 
-    value.mg += value2.mg;
-    value.eg += value2.eg;
+    value.packed += value2.packed;
     return value;
 
 }
 
-inline EvalTerm operator-=(EvalTerm& value, const EvalTerm value2) {
+constexpr EvalTerm operator-=(EvalTerm& value, const EvalTerm value2) {
 
-    value.mg -= value2.mg;
-    value.eg -= value2.eg;
+    value.packed -= value2.packed;
     return value;
 
 }
 
-inline EvalTerm operator+(const EvalTerm value1, const EvalTerm value2) {
+constexpr EvalTerm operator+(const EvalTerm value1, const EvalTerm value2) {
 
-    EvalTerm value;
-    value.mg = value1.mg + value2.mg;
-    value.eg = value1.eg + value2.eg;
-    return value;
+    return EvalTerm::from_packed(value1.packed + value2.packed);
 
 }
 
-inline EvalTerm operator-(const EvalTerm value1, const EvalTerm value2) {
+constexpr EvalTerm operator-(const EvalTerm value1, const EvalTerm value2) {
 
-    EvalTerm value;
-    value.mg = value1.mg - value2.mg;
-    value.eg = value1.eg - value2.eg;
-    return value;
+    return EvalTerm::from_packed(value1.packed - value2.packed);
 
 }
 
-inline EvalTerm operator*(const EvalTerm value1, const int multiply) {
+constexpr EvalTerm operator*(const EvalTerm value1, const int multiply) {
 
-    EvalTerm value;
-    value.mg = value1.mg * multiply;
-    value.eg = value1.eg * multiply;
-    return value;
+    return EvalTerm::from_packed(value1.packed * multiply);
 
 }
 
-inline EvalTerm operator*=(EvalTerm& value, const int multiply) {
+constexpr EvalTerm operator*=(EvalTerm& value, const int multiply) {
 
-    value.mg *= multiply;
-    value.eg *= multiply;
+    value.packed *= multiply;
     return value;
 
 }
 
-inline EvalTerm operator/(const EvalTerm value1, const int divisor) {
+// Division does not carry over between the packed values, so both are divided separately
+constexpr EvalTerm operator/(const EvalTerm value1, const int divisor) {
 
-    EvalTerm value;
-    value.mg = value1.mg / divisor;
-    value.eg = value1.eg / divisor;
-    return value;
+    return V(value1.mg() / divisor, value1.eg() / divisor);
 
 }
 
@@ -511,7 +514,7 @@ inline File& operator--(File& f) {
 // Print a value to the console, showing the midgame and endgame terms
 inline std::ostream& operator<<(std::ostream& os, const EvalTerm& value) {
 
-    return os << "MG: " << value.mg << " | EG: " << value.eg;
+    return os << "MG: " << value.mg() << " | EG: " << value.eg();
 
 }
 
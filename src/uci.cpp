@@ -20,6 +20,7 @@
   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
   SOFTWARE.
 */
+#include <algorithm>
 #include <sstream>
 #include <stdlib.h>
 
@@ -29,19 +30,37 @@
 #include "timeman.hpp"
 #include "thread.hpp"
 #include "bench.hpp"
+#include "trace.hpp"
+#include "dataset.hpp"
+#include "tune.hpp"
+#include "datagen.hpp"
+#include "analyze.hpp"
+#include "io.hpp"
 
 SpinOption   ThreadsOption      = SpinOption("Threads", 1, 1, 4);
 SpinOption   HashOption         = SpinOption("Hash", 64, 1, 4096);
 ButtonOption ClearHashOption    = ButtonOption("Clear Hash", [] { TTable.clear(); });
 SpinOption   MoveOverheadOption = SpinOption("MoveOverhead", 100, 0, 10000);
 SpinOption   MultiPVOption      = SpinOption("MultiPV", 1, 1, 100);
-
-const Option* Options[5] = {
+SpinOption   PawnHashOption     = SpinOption("PawnHash", 4, 1, 256);
+SpinOption   EvalCacheOption    = SpinOption("EvalCache", 1, 1, 256);
+CheckOption  UseNNUEOption      = CheckOption("Use NNUE", false);
+StringOption EvalFileOption     = StringOption("EvalFile", "<empty>");
+CheckOption  AttackMapsOption   = CheckOption("AttackMaps", false);
+CheckOption  PonderOption       = CheckOption("Ponder", false);
+
+const Option* Options[11] = {
     &ThreadsOption,
     &HashOption,
     &ClearHashOption,
     &MoveOverheadOption,
     &MultiPVOption,
+    &PawnHashOption,
+    &EvalCacheOption,
+    &UseNNUEOption,
+    &EvalFileOption,
+    &AttackMapsOption,
+    &PonderOption,
 };
 
 ThreadPool Threads(ThreadsOption.get_default());
@@ -54,11 +73,26 @@ namespace UCI {
         TTable.set_size(HashOption.get_default());
     }
 
+    // Format a score in centipawns or, if a mate was found, in moves until the mate
+    std::string value_to_string(const Value value) {
+
+        if (std::abs(value) >= VALUE_MATE_MAX) {
+            return "mate " + std::to_string(mate_distance(value));
+        }
+
+        return "cp " + std::to_string(value);
+
+    }
+
     // This function receives various information about the current search iteration and prints
     // information like current depth, selective depth, duration, score... to the console. It
     // also shows a principal variation (the suggested line of play)
     void send_pv(const SearchInfo& info, const Value value, const PrincipalVariation& pv, const uint64_t nodes, const Value alpha, const Value beta) {
 
+        if (Threads.is_silent()) {
+            return;
+        }
+
         std::stringstream ss;
         Duration duration = get_time_elapsed(info.start);
 
@@ -71,12 +105,7 @@ namespace UCI {
             ss << " multipv " << info.multiPv + 1;
         }
 
-        // Show the score (in centipawns) or if a mate was found, the plies until the mate
-        if (std::abs(value) >= VALUE_MATE_MAX) {
-            ss << " score mate " << (value > 0 ? VALUE_MATE - value + 1 : -VALUE_MATE - value) / 2;
-        } else {
-            ss << " score cp " << value;
-        }
+        ss << " score " << value_to_string(value);
 
         if (value >= beta) {
             ss << " lowerbound";
@@ -98,42 +127,53 @@ namespace UCI {
             }
         }
 
-        ss << std::endl;
-        
-        std::cout << ss.str();
+        IO::send(ss.str());
 
     }
 
     void send_string(const std::string& string) {
         
-        std::cout << "info string " << string << std::endl;
+        IO::send("info string " + string);
 
     }
 
     void send_currmove(const Move currentMove, const unsigned index) {
 
-        std::cout << "info currmove " << move_to_string(currentMove) << " currmovenumber " << index << std::endl;
+        if (Threads.is_silent()) {
+            return;
+        }
+
+        IO::send("info currmove " + move_to_string(currentMove) + " currmovenumber " + std::to_string(index));
 
     }
 
     // Show the best move for the current position in the console; if the position is mate or stalemate, the engine will output "none"
     void send_bestmove(const Move bestMove) {
 
-        std::cout << "bestmove " << (bestMove != MOVE_NONE ? move_to_string(bestMove) : "none") << std::endl;
+        if (Threads.is_silent()) {
+            return;
+        }
+
+        IO::send("bestmove " + (bestMove != MOVE_NONE ? move_to_string(bestMove) : "none"));
 
     }
 
     // Send the engine identification and options to the console; end it with a "uciok"
     static void show_information() {
 
-        std::cout << "id name Delocto " << VERSION << std::endl;
-        std::cout << "id author Moritz Terink" << std::endl << std::endl;
+        std::stringstream name;
+        name << "id name Delocto " << VERSION;
+
+        IO::send(name.str());
+        IO::send("id author Moritz Terink");
+        IO::send("");
 
         for (const Option* option : Options) {
-            std::cout << option->uci_string() << std::endl;
+            IO::send(option->uci_string());
         }
         
-        std::cout << "uciok" << std::endl << std::endl;
+        IO::send("uciok");
+        IO::send("");
 
     }
 
@@ -196,6 +236,38 @@ namespace UCI {
             isValid = MoveOverheadOption.set_value(std::stoi(valueRaw));
         } else if (name == MultiPVOption.name) {
             isValid = MultiPVOption.set_value(std::stoi(valueRaw));
+        } else if (name == PawnHashOption.name) {
+            int value = std::stoi(valueRaw);
+            isValid = PawnHashOption.set_value(value);
+            if (isValid) {
+                Threads.set_pawn_table_size(value);
+            }
+        } else if (name == EvalCacheOption.name) {
+            int value = std::stoi(valueRaw);
+            isValid = EvalCacheOption.set_value(value);
+            if (isValid) {
+                Threads.set_eval_cache_size(value);
+            }
+        } else if (name == UseNNUEOption.name) {
+            isValid = (valueRaw == "true" || valueRaw == "false") && UseNNUEOption.set_value(valueRaw == "true");
+            if (isValid) {
+                NNUE::set_enabled(UseNNUEOption.get_value());
+                if (UseNNUEOption.get_value() && !NNUE::is_loaded()) {
+                    send_string("Warning: no network loaded, set EvalFile first");
+                }
+            }
+        } else if (name == EvalFileOption.name) {
+            isValid = EvalFileOption.set_value(valueRaw);
+            if (isValid && !NNUE::load(valueRaw)) {
+                send_string("Error: Failed to load network from " + valueRaw);
+            }
+        } else if (name == AttackMapsOption.name) {
+            isValid = (valueRaw == "true" || valueRaw == "false") && AttackMapsOption.set_value(valueRaw == "true");
+            if (isValid) {
+                AttackMaps::set_enabled(AttackMapsOption.get_value());
+            }
+        } else if (name == PonderOption.name) {
+            isValid = (valueRaw == "true" || valueRaw == "false") && PonderOption.set_value(valueRaw == "true");
         } else if (name == ClearHashOption.name) {
             isValid = true;
             ClearHashOption.push();
@@ -261,6 +333,8 @@ namespace UCI {
             if (part == "infinite") {
                 limits.infinite = true;
                 break;
+            } else if (part == "ponder") {
+                limits.ponder = true;
             } else if (part == "depth") {
                 ss >> part;
                 limits.depth = std::min(std::stoi(part), DEPTH_MAX);
@@ -287,6 +361,21 @@ namespace UCI {
         go(board, limits);
     }
 
+    // Check if the input is a command of the UCI protocol, which only produces output through send functions
+    static bool is_protocol_command(const std::string& input) {
+
+        static const std::string ProtocolCommands[] = {
+            "uci", "ucinewgame", "isready", "setoption", "position", "go", "stop", "ponderhit", "quit"
+        };
+
+        std::stringstream ss(input);
+        std::string word;
+        ss >> word;
+
+        return std::find(std::begin(ProtocolCommands), std::end(ProtocolCommands), word) != std::end(ProtocolCommands);
+
+    }
+
     // Parse a string and act according to the UCI protocol
     bool parse_uci_input(std::string input, Board& board) {
 
@@ -308,7 +397,7 @@ namespace UCI {
             
             // A sort of ping command sent by the user interface to check if the engine is still responsive
             if (word == "isready") {
-                std::cout << "readyok" << std::endl;
+                IO::send("readyok");
                 break;
             }
 
@@ -333,17 +422,28 @@ namespace UCI {
                 break;
             }
 
+            // The opponent played the expected move, continue the ponder search as a normal search
+            if (word == "ponderhit") {
+                Threads.ponderhit();
+                break;
+            }
+
             // Output an evaluation of the current position. Useful for debugging
             if (word == "eval") {
                 evaluate_info(board);
                 break;
             }
 
-            // Run a perft test
+            // Run a perft test; with "breakdown", moves are also classified by type
             if (word == "perft") {
                 Depth depth;
-                ss >> depth;
-                runPerft(board.get_fen(), depth);
+                std::string mode;
+                ss >> depth >> mode;
+                if (mode == "breakdown") {
+                    runPerftBreakdown(board.get_fen(), depth);
+                } else {
+                    runPerft(board.get_fen(), depth);
+                }
                 break;
             }
 
@@ -355,9 +455,102 @@ namespace UCI {
                 break;
             }
 
-            // Run a benchmark
+            // Run a benchmark; optional arguments are limit, threads, hash size,
+            // position file and limit type (depth, nodes or movetime), followed
+            // by the report format, number of trials and output file
             if (word == "bench") {
-                benchmark();
+                BenchmarkSettings settings;
+                if (parse_benchmark_settings(ss, settings)) {
+                    benchmark(settings);
+                }
+                break;
+            }
+
+            // Trace the search tree into files, or stop tracing with "trace off"
+            if (word == "trace") {
+                std::string filename;
+                ss >> filename;
+#ifdef SEARCH_TRACE
+                if (!Threads.set_trace(filename == "off" ? "" : filename)) {
+                    send_string("Error: could not open trace file " + filename);
+                }
+#else
+                send_string("Search tracing is not available in this build; build with make TRACE=yes");
+#endif
+                break;
+            }
+
+            // Summarize a search trace file, optionally listing the largest subtrees up to the given ply
+            if (word == "traceanalyze") {
+                std::string filename;
+                unsigned plies = 1;
+                ss >> filename >> plies;
+                analyze_trace(filename, plies, std::cout);
+                break;
+            }
+
+            // Show the search statistics of the last search
+            if (word == "stats") {
+#ifdef SEARCH_STATS
+                print_search_stats(std::cout, Threads.get_search_stats());
+#else
+                send_string("Search statistics are not available in this build; build with make STATS=yes");
+#endif
+                break;
+            }
+
+            // Convert a text file with labelled positions (FEN and game result) into a dataset
+            // file; the optional argument is the number of threads
+            if (word == "pack") {
+                std::string input, output;
+                unsigned threadCount = 1;
+                uint64_t skipped;
+                ss >> input >> output >> threadCount;
+                const uint64_t converted = Dataset::convert(input, output, std::max(1u, threadCount), skipped);
+                send_string("Packed " + std::to_string(converted) + " positions, skipped " + std::to_string(skipped) + " lines");
+                break;
+            }
+
+            // Generate a dataset with self-play games; arguments are the output file followed
+            // by the optional number of positions, nodes per move, threads and random opening plies
+            if (word == "datagen") {
+                DatagenSettings settings;
+                if (parse_datagen_settings(ss, settings)) {
+                    generate_data(settings);
+                }
+                break;
+            }
+
+            // Analyse the positions of an EPD file with independent searches on every thread; arguments
+            // are the input file, the limits of every search (e.g. depth 10 threads 4) and the output file
+            if (word == "analyze") {
+                AnalysisSettings settings;
+                if (parse_analysis_settings(ss, settings)) {
+                    analyze_positions(settings);
+                }
+                break;
+            }
+
+            // Tune the evaluation on a dataset file; optional arguments are the number
+            // of iterations, threads and the learning rate
+            if (word == "tune") {
+                std::string filename;
+                unsigned iterations = 1000, threadCount = 1;
+                double learningRate = 1.0;
+                ss >> filename >> iterations >> threadCount >> learningRate;
+#ifdef EVAL_TUNE
+                Tune::tune(filename, iterations, std::max(1u, threadCount), learningRate);
+#else
+                send_string("Evaluation tuning is not available in this build; build with make TUNE=yes");
+#endif
+                break;
+            }
+
+            // Compare the NPS of two JSON benchmark reports
+            if (word == "benchcompare") {
+                std::string first, second;
+                ss >> first >> second;
+                compare_benchmarks(first, second);
                 break;
             }
 
@@ -387,15 +580,31 @@ namespace UCI {
         // If we received command line arguments, only execute them
         // and then quit immediately
         if (argc > 1) {
-            parse_uci_input(argv[1], board);
+            std::string command = argv[1];
+            for (int i = 2; i < argc; i++) {
+                command += " " + std::string(argv[i]);
+            }
+            parse_uci_input(command, board);
         } else {
             std::string input;
             bool shouldQuit = false;
 
+            // Protocol output is written by the output thread from now on
+            IO::start();
+
             while (!shouldQuit) {
-                std::getline(std::cin, input);
+                // The end of the input is handled like a quit command
+                if (!std::getline(std::cin, input)) {
+                    input = "quit";
+                }
+                // Commands with reports of their own write to the console directly, after the queued output
+                if (!is_protocol_command(input)) {
+                    IO::flush();
+                }
                 shouldQuit = parse_uci_input(input, board);
             }
+
+            IO::stop();
         }
     }
 }
\ No newline at end of file
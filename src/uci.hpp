@@ -73,7 +73,7 @@ class CheckOption : public Option {
         }
 
         std::string uci_string() const override {
-            return Option::uci_string() + "check default " + std::to_string(defaultValue);
+            return Option::uci_string() + "check default " + (defaultValue ? "true" : "false");
         }
 
 };
@@ -212,6 +212,12 @@ class StringOption : public Option {
 extern SpinOption ThreadsOption;
 extern SpinOption HashOption;
 extern SpinOption MoveOverheadOption;
+extern SpinOption PawnHashOption;
+extern SpinOption EvalCacheOption;
+extern CheckOption UseNNUEOption;
+extern StringOption EvalFileOption;
+extern CheckOption AttackMapsOption;
+extern CheckOption PonderOption;
 
 extern ThreadPool Threads;
 extern TranspositionTable TTable;
@@ -219,10 +225,12 @@ extern TranspositionTable TTable;
 namespace UCI {
     extern void init();
     extern void loop(int argc, char* argv[]);
+    extern bool parse_uci_input(std::string input, Board& board);
     extern void send_pv(const SearchInfo& info, const Value value, const PrincipalVariation& pv, const uint64_t nodes, const Value alpha, const Value beta);
     extern void send_currmove(const Move currentMove, const unsigned index);
     extern void send_bestmove(const Move bestMove);
     extern void send_string(const std::string& string);
+    extern std::string value_to_string(const Value value);
     extern void go(const Board& board, const SearchLimits& limits);
 }
 
@@ -0,0 +1,120 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <fstream>
+#include <set>
+
+#include "./catch.hpp"
+
+#include "../src/analyze.hpp"
+#include "../src/movegen.hpp"
+#include "../src/uci.hpp"
+
+// Every position of the input is analysed exactly once, invalid lines are skipped
+TEST_CASE("Position analysis") {
+
+    static const std::string lines[] = {
+        "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - bm Bxg5; id \"test\";",
+        "not a position",
+        "7k/6Q1/6K1/8/8/8/8/8 b - -",
+        "4k3/8/8/8/8/8/4R3/4K3 w - - 0 1",
+        "8/8/8/8/8/5k2/8/4K2R w K - 0 1"
+    };
+
+    const std::string input = "analyze_test.epd", output = "analyze_test.out";
+
+    std::ofstream file(input);
+    for (const std::string& line : lines) {
+        file << line << '\n';
+    }
+    file.close();
+
+    std::stringstream ss("analyze_test.epd depth 4 threads 2 analyze_test.out");
+    AnalysisSettings settings;
+    REQUIRE(parse_analysis_settings(ss, settings));
+    REQUIRE(settings.limits.depth == 4);
+    REQUIRE(settings.threads == 2);
+
+    REQUIRE(analyze_positions(settings) == 4);
+
+    std::ifstream results(output);
+    std::string line;
+    std::set<unsigned> lineNumbers;
+
+    while (std::getline(results, line)) {
+
+        const unsigned lineNumber = std::stoi(line.substr(line.rfind("line ") + 5));
+        REQUIRE(lineNumbers.insert(lineNumber).second);
+
+        // The best move is a legal move of the analysed position
+        Board board;
+        board.set_fen(line.substr(0, line.find(" bestmove")));
+        const std::string bestMove = line.substr(line.find("bestmove ") + 9, line.find(';') - line.find("bestmove ") - 9);
+        const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+
+        if (lineNumber == 4) {
+            REQUIRE(bestMove == "none");
+            REQUIRE(line.find("score mate 0") != std::string::npos);
+        } else {
+            REQUIRE(std::find_if(moves.begin(), moves.end(), [&](const Move move) { return move_to_string(move) == bestMove; }) != moves.end());
+            REQUIRE(line.find("depth 4;") != std::string::npos);
+        }
+
+    }
+
+    REQUIRE(lineNumbers == std::set<unsigned>{ 1, 2, 4, 6 });
+
+    results.close();
+    std::remove(input.c_str());
+    std::remove(output.c_str());
+
+}
+
+// Analysis needs an input file, an output file and at least one limit
+TEST_CASE("Analysis settings") {
+
+    AnalysisSettings settings;
+
+    std::stringstream noLimit("in.epd out.txt");
+    REQUIRE(!parse_analysis_settings(noLimit, settings));
+
+    std::stringstream missingValue("in.epd depth out.txt");
+    REQUIRE(!parse_analysis_settings(missingValue, settings));
+
+    std::stringstream unknownLimit("in.epd wtime 1000 out.txt");
+    REQUIRE(!parse_analysis_settings(unknownLimit, settings));
+
+    std::stringstream valid("in.epd nodes 1000 movetime 50 out.txt");
+    REQUIRE(parse_analysis_settings(valid, settings));
+    REQUIRE(settings.input == "in.epd");
+    REQUIRE(settings.output == "out.txt");
+    REQUIRE(settings.limits.nodes == 1000);
+    REQUIRE(settings.limits.moveTime == 50);
+
+    // The number of threads is kept within the range of the Threads option
+    std::stringstream tooManyThreads("in.epd depth 10 threads 100000 out.txt");
+    REQUIRE(parse_analysis_settings(tooManyThreads, settings));
+    REQUIRE(settings.threads == unsigned(ThreadsOption.get_max()));
+
+}
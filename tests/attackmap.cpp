@@ -0,0 +1,132 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <cstring>
+
+#include "./catch.hpp"
+
+#include "../src/board.hpp"
+#include "../src/movegen.hpp"
+
+// Compare the attack map of the board with one computed from the pieces without the attack map code
+static void check_attacks(const Board& board) {
+
+    const AttackMaps::AttackMap& map = board.attack_map();
+
+    unsigned counts[COLOR_COUNT][SQUARE_COUNT] = {};
+    Bitboard colorAttacks[COLOR_COUNT] = {};
+
+    for (Square sq = 0; sq < SQUARE_COUNT; sq++) {
+        if (board.is_sq_empty(sq)) {
+            REQUIRE(map.pieces[sq] == AttackMaps::NoPiece);
+            REQUIRE(map.squareAttacks[sq] == 0);
+            continue;
+        }
+
+        const Color color  = board.owner(sq);
+        const Piecetype pt = board.piecetype(sq);
+        const Bitboard attacks = pt == PAWN ? PawnAttacks[color][sq] : piece_attacks(pt, sq, board.pieces(BOTH));
+
+        REQUIRE(map.pieces[sq] == PIECETYPE_COUNT * color + pt);
+        REQUIRE(map.squareAttacks[sq] == attacks);
+        REQUIRE((map.pieceAttacks[color][pt] & attacks) == attacks);
+
+        colorAttacks[color] |= attacks;
+        for (Square target = 0; target < SQUARE_COUNT; target++) {
+            counts[color][target] += bool(attacks & SQUARES[target]);
+        }
+    }
+
+    for (Color c = WHITE; c < COLOR_COUNT; ++c) {
+        REQUIRE(map.colorAttacks[c] == colorAttacks[c]);
+        for (Square sq = 0; sq < SQUARE_COUNT; sq++) {
+            REQUIRE(AttackMaps::attacker_count(map, c, sq) == counts[c][sq]);
+        }
+    }
+
+}
+
+// Play all legal moves to the given depth and compare the incrementally updated attack map with
+// a freshly computed one after every move and every undone move. The move generation, legality
+// checks and static exchange evaluation have to give the same results as without attack maps
+static void check_attack_map(Board& board, const unsigned depth) {
+
+    AttackMaps::AttackMap refreshed;
+    AttackMaps::refresh(board, refreshed);
+    REQUIRE(std::memcmp(&board.attack_map(), &refreshed, sizeof(AttackMaps::AttackMap)) == 0);
+    check_attacks(board);
+
+    const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+
+    AttackMaps::set_enabled(false);
+    Board reference;
+    reference.set_fen(board.get_fen());
+    AttackMaps::set_enabled(true);
+
+    REQUIRE(!reference.has_attack_map());
+    REQUIRE(board.checkers() == reference.checkers());
+    REQUIRE(moves.size() == generate_moves<ALL, LEGAL>(reference, reference.turn()).size());
+
+    for (const Move move : moves) {
+        REQUIRE(board.see(move) == reference.see(move));
+        REQUIRE(board.see_ge(move, 0) == reference.see_ge(move, 0));
+    }
+
+    if (depth == 0) {
+        return;
+    }
+
+    for (unsigned i = 0; i < moves.size(); i++) {
+        board.do_move(moves[i]);
+        check_attack_map(board, depth - 1);
+        board.undo_move();
+        REQUIRE(std::memcmp(&board.attack_map(), &refreshed, sizeof(AttackMaps::AttackMap)) == 0);
+    }
+
+}
+
+TEST_CASE("Attack maps") {
+    static const std::string fens[] = {
+        INITIAL_POSITION_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1"
+    };
+
+    AttackMaps::set_enabled(true);
+
+    Board board;
+    for (const std::string fen : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            board.set_fen(fen);
+            REQUIRE(board.has_attack_map());
+            check_attack_map(board, 2);
+        }
+    }
+
+    AttackMaps::set_enabled(false);
+
+    board.set_fen(INITIAL_POSITION_FEN);
+    REQUIRE(!board.has_attack_map());
+}
@@ -21,6 +21,8 @@
   SOFTWARE.
 */
 
+#include <fstream>
+
 #include "./catch.hpp"
 
 #include "../src/bench.hpp"
@@ -30,4 +32,92 @@ TEST_CASE("Benchmark consistency") {
     uint64_t bench1 = benchmark();
     uint64_t bench2 = benchmark();
     REQUIRE(bench1 == bench2);
-}
\ No newline at end of file
+}
+TEST_CASE("Benchmark settings parsing") {
+
+    SECTION("Defaults") {
+        std::stringstream ss("");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        REQUIRE(settings.limit == 8);
+        REQUIRE(settings.threads == 1);
+        REQUIRE(settings.positions == "default");
+        REQUIRE(settings.limitType == BENCH_DEPTH);
+    }
+
+    SECTION("All arguments") {
+        std::stringstream ss("100000 4 256 positions.epd nodes");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        REQUIRE(settings.limit == 100000);
+        REQUIRE(settings.threads == 4);
+        REQUIRE(settings.hashSize == 256);
+        REQUIRE(settings.positions == "positions.epd");
+        REQUIRE(settings.limitType == BENCH_NODES);
+    }
+
+    SECTION("Invalid limit type") {
+        std::stringstream ss("8 1 16 default plies");
+        BenchmarkSettings settings;
+        REQUIRE(!parse_benchmark_settings(ss, settings));
+    }
+
+}
+
+TEST_CASE("Benchmark report") {
+
+    SECTION("Report options") {
+        std::stringstream ss("5 1 16 default depth format json trials 3 output report.json");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        REQUIRE(settings.limit == 5);
+        REQUIRE(settings.format == FORMAT_JSON);
+        REQUIRE(settings.trials == 3);
+        REQUIRE(settings.output == "report.json");
+    }
+
+    SECTION("JSON report contains every trial") {
+        std::stringstream ss("3 1 16 default depth format json trials 2 output bench_report_test.json");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        uint64_t nodes = benchmark(settings);
+        REQUIRE(nodes > 0);
+        std::vector<double> trials = read_benchmark_report("bench_report_test.json");
+        REQUIRE(trials.size() == 2);
+        REQUIRE(trials[0] > 0);
+        std::remove("bench_report_test.json");
+    }
+
+    SECTION("Positions file with Windows line endings") {
+        const std::string fen = "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12";
+        {
+            std::ofstream positions("bench_crlf_test.epd", std::ios::binary);
+            positions << fen << "\r\n" << "\r\n";
+        }
+        std::stringstream ss("2 1 16 bench_crlf_test.epd depth format json output bench_crlf_test.json");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        REQUIRE(benchmark(settings) > 0);
+
+        std::ifstream file("bench_crlf_test.json");
+        std::stringstream report;
+        report << file.rdbuf();
+        REQUIRE(report.str().find("\"fen\": \"" + fen + "\"") != std::string::npos);
+        REQUIRE(report.str().find('\r') == std::string::npos);
+        REQUIRE(read_benchmark_report("bench_crlf_test.json").size() == 1);
+        std::remove("bench_crlf_test.epd");
+        std::remove("bench_crlf_test.json");
+    }
+
+
+    SECTION("Hardware counters do not affect the search") {
+        std::stringstream ss("4 1 16 default depth format csv output bench_counters_test.csv");
+        BenchmarkSettings settings;
+        REQUIRE(parse_benchmark_settings(ss, settings));
+        uint64_t nodes = benchmark(settings);
+        settings.counters = true;
+        REQUIRE(benchmark(settings) == nodes);
+        std::remove("bench_counters_test.csv");
+    }
+
+}
@@ -72,6 +72,93 @@ TEST_CASE("Parse FEN") {
     }
 }
 
+// Packing and unpacking a position has to restore the complete board state
+TEST_CASE("Packed positions") {
+    static const std::string fens[] = {
+        INITIAL_POSITION_FEN,
+        "4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1",
+        "r3k2r/8/8/8/8/8/8/R3K2R w Kq - 0 1",
+        "4k3/8/8/8/8/8/P7/4K3 w - - 22 32",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12",
+        "3k4/8/8/8/8/8/3r4/3K4 w - - 0 70"
+    };
+
+    for (const std::string& fen : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            Board reference, board;
+            reference.set_fen(fen);
+
+            const PackedPosition position = reference.to_packed();
+            REQUIRE(board.from_packed(position));
+
+            REQUIRE(board.get_fen() == fen);
+            REQUIRE(board.hashkey() == reference.hashkey());
+            REQUIRE(board.pawnkey() == reference.pawnkey());
+            REQUIRE(board.checkers() == reference.checkers());
+            REQUIRE(board.material(WHITE) == reference.material(WHITE));
+            REQUIRE(board.material(BLACK) == reference.material(BLACK));
+            REQUIRE(board.pst(WHITE) == reference.pst(WHITE));
+            REQUIRE(board.pst(BLACK) == reference.pst(BLACK));
+        }
+    }
+
+    SECTION("Malformed position") {
+        Board board;
+        board.set_fen(INITIAL_POSITION_FEN);
+
+        PackedPosition position = board.to_packed();
+        position.pieces[2] = 0x77; // Invalid piece types
+        REQUIRE(!board.from_packed(position));
+        REQUIRE(board.get_fen() == INITIAL_POSITION_FEN);
+    }
+
+    SECTION("Illegal positions") {
+        Board board, reference;
+
+        const auto packed = [&reference](const std::string& fen) {
+            reference.set_fen(fen);
+            return reference.to_packed();
+        };
+
+        // En-passant square on the wrong rank, without a pawn in front of it or occupied
+        PackedPosition position = packed("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1");
+        position.enPassant = SQUARE_E6;
+        REQUIRE(!board.from_packed(position));
+        position = packed("4k3/8/8/8/3pP3/8/8/4K3 b - e3 0 1");
+        position.flags ^= 1;
+        REQUIRE(!board.from_packed(position));
+        position = packed("4k3/8/8/8/3p4/8/8/4K3 b - - 0 1");
+        position.enPassant = SQUARE_E3;
+        REQUIRE(!board.from_packed(position));
+        position = packed("4k3/8/8/8/3pP3/4N3/8/4K3 b - - 0 1");
+        position.enPassant = SQUARE_E3;
+        REQUIRE(!board.from_packed(position));
+
+        // Pawns on the first or last rank
+        REQUIRE(!board.from_packed(packed("P3k3/8/8/8/8/8/8/4K3 w - - 0 1")));
+        REQUIRE(!board.from_packed(packed("4k3/8/8/8/8/8/8/p3K3 w - - 0 1")));
+
+        // Castling rights without the king or the rook on its original square
+        position = packed("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+        position.flags |= CASTLE_WHITE_SHORT << 1;
+        REQUIRE(!board.from_packed(position));
+        position = packed("r3k3/8/8/8/8/8/8/3K4 w - - 0 1");
+        position.flags |= CASTLE_BLACK_LONG << 1;
+        REQUIRE(board.from_packed(position));
+        position = packed("r4k2/8/8/8/8/8/8/3K4 w - - 0 1");
+        position.flags |= CASTLE_BLACK_LONG << 1;
+        REQUIRE(!board.from_packed(position));
+
+        // The side which is not to move is in check
+        REQUIRE(!board.from_packed(packed("4k3/8/8/8/8/8/8/4R1K1 w - - 0 1")));
+        REQUIRE(!board.from_packed(packed("4k3/3P4/8/8/8/8/8/4K3 w - - 0 1")));
+        REQUIRE(board.from_packed(packed("4k3/3P4/8/8/8/8/8/4K3 b - - 0 1")));
+
+        // The board keeps the last valid position
+        REQUIRE(board.get_fen() == "4k3/3P4/8/8/8/8/8/4K3 b - - 0 1");
+    }
+}
+
 // Moves played on the board should update the board's internal state correctly
 TEST_CASE("Applying moves") {
 
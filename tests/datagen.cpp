@@ -0,0 +1,122 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "./catch.hpp"
+
+#include "../src/datagen.hpp"
+#include "../src/dataset.hpp"
+#include "../src/movegen.hpp"
+#include "../src/thread.hpp"
+#include "../src/uci.hpp"
+
+// Every thread of the pool searches its own position and stops at its own node limit
+TEST_CASE("Independent searches") {
+
+    static const std::string fens[] = {
+        "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12"
+    };
+
+    SearchLimits limits;
+    limits.nodes = 5000;
+
+    SearchResult results[2];
+
+    Threads.resize(2);
+    Threads.start_jobs([&](Thread& thread) {
+        Board board;
+        board.set_fen(fens[thread.get_index()]);
+        results[thread.get_index()] = thread.search_alone(board, limits);
+    });
+    Threads.wait_until_finished();
+    Threads.stop_searching();
+    Threads.resize(ThreadsOption.get_value());
+
+    Board board;
+    for (unsigned i = 0; i < 2; i++) {
+        board.set_fen(fens[i]);
+        MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+        REQUIRE(std::find(moves.begin(), moves.end(), results[i].bestMove) != moves.end());
+        REQUIRE(results[i].depth > 0);
+        REQUIRE(results[i].nodes >= limits.nodes);
+        REQUIRE(results[i].nodes < limits.nodes + 2048); // The limit is checked every 1024 nodes
+    }
+
+}
+
+// Generated games are appended to an existing dataset
+TEST_CASE("Data generation") {
+
+    const std::string filename = "datagen_test.bin";
+    std::remove(filename.c_str());
+
+    DatagenSettings settings;
+    settings.output = filename;
+    settings.positions = 20;
+    settings.nodes = 500;
+
+    const uint64_t first = generate_data(settings);
+    REQUIRE(first >= 20);
+
+    settings.positions = first + 1;
+    const uint64_t second = generate_data(settings);
+    REQUIRE(second >= 1);
+
+    Dataset::Reader reader;
+    REQUIRE(reader.open(filename));
+    REQUIRE(reader.size() == first + second);
+
+    Board board;
+    for (uint64_t i = 0; i < reader.size(); i++) {
+        REQUIRE(reader[i].result < Dataset::RESULT_COUNT);
+        REQUIRE(std::abs(reader[i].score) < VALUE_MATE_MAX);
+        REQUIRE(board.from_packed(reader[i]));
+        REQUIRE(!board.checkers());
+    }
+
+    reader.close();
+    std::remove(filename.c_str());
+
+}
+
+TEST_CASE("Data generation settings") {
+
+    DatagenSettings settings;
+
+    std::stringstream noOutput("");
+    REQUIRE(!parse_datagen_settings(noOutput, settings));
+
+    std::stringstream valid("data.bin 1000 5000 2 8");
+    REQUIRE(parse_datagen_settings(valid, settings));
+    REQUIRE(settings.output == "data.bin");
+    REQUIRE(settings.positions == 1000);
+    REQUIRE(settings.nodes == 5000);
+    REQUIRE(settings.threads == 2);
+    REQUIRE(settings.randomPlies == 8);
+
+    // The number of threads is kept within the range of the Threads option
+    std::stringstream tooManyThreads("data.bin 1000 5000 100000");
+    REQUIRE(parse_datagen_settings(tooManyThreads, settings));
+    REQUIRE(settings.threads == unsigned(ThreadsOption.get_max()));
+
+}
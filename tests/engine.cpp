@@ -0,0 +1,150 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "./catch.hpp"
+
+#include "../src/engine.hpp"
+#include "../src/libdelocto.h"
+#include "../src/movegen.hpp"
+#include "../src/uci.hpp"
+
+// Check that the principal variation is a sequence of legal moves starting with the best move
+static void check_result(const std::string& fen, const SearchResult& result) {
+
+    Board board;
+    board.set_fen(fen);
+
+    REQUIRE(result.depth > 0);
+    REQUIRE(!result.pv.empty());
+    REQUIRE(result.pv[0] == result.bestMove);
+
+    for (const Move move : result.pv) {
+        const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+        REQUIRE(std::find(moves.begin(), moves.end(), move) != moves.end());
+        board.do_move(move);
+    }
+
+}
+
+// Several engine instances search at the same time and report their results through callbacks
+TEST_CASE("Engine instances") {
+
+    static const std::string fens[] = {
+        "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+    };
+
+    Engine engines[3];
+    SearchResult results[3];
+
+    SearchLimits limits;
+    limits.nodes = 5000;
+
+    for (unsigned i = 0; i < 3; i++) {
+        REQUIRE(engines[i].set_position(fens[i]));
+        engines[i].search(limits, [&results, i](const SearchResult& result) { results[i] = result; });
+    }
+
+    for (unsigned i = 0; i < 3; i++) {
+        engines[i].wait();
+        check_result(fens[i], results[i]);
+        REQUIRE(results[i].nodes >= limits.nodes);
+    }
+
+    // The synchronous search waits for the result
+    check_result(fens[1], engines[1].search(limits));
+
+    // Invalid positions are rejected and the previous position is kept
+    REQUIRE(!engines[0].set_position("not a position"));
+    REQUIRE(!engines[0].set_position("4k3/8/8/8/8/8/4R3/4K3 w - - 0 1"));
+    REQUIRE(engines[0].get_position().get_fen() == fens[0]);
+
+    // Packed positions
+    Board board;
+    board.set_fen(fens[2]);
+    REQUIRE(engines[0].set_position(board.to_packed()));
+    REQUIRE(engines[0].get_position().get_fen() == fens[2]);
+
+    // Checkmate is reported without a search
+    REQUIRE(engines[0].set_position("7k/6Q1/6K1/8/8/8/8/8 b - - 0 1"));
+    const SearchResult mate = engines[0].search(limits);
+    REQUIRE(mate.bestMove == MOVE_NONE);
+    REQUIRE(mate.value == -VALUE_MATE);
+
+}
+
+// An infinite search only ends when it is stopped, a stop request of the pool does not affect it
+TEST_CASE("Engine stop") {
+
+    Engine engine;
+    std::atomic<bool> finished{false};
+
+    SearchLimits limits;
+    limits.infinite = true;
+
+    engine.search(limits, [&finished](const SearchResult&) { finished = true; });
+    Threads.stop_searching();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(!finished);
+
+    engine.stop();
+    engine.wait();
+    REQUIRE(finished);
+
+}
+
+static void store_result(const DeloctoResult* result, void* userData) {
+
+    *static_cast<DeloctoResult*>(userData) = *result;
+
+}
+
+// The C interface converts results into strings in UCI notation
+TEST_CASE("Engine C interface") {
+
+    // The tables were already initialized by the test runner, so delocto_init() is not called
+    DeloctoEngine* engine = delocto_engine_new();
+    DeloctoResult result = {};
+    DeloctoLimits limits = {};
+    limits.depth = 6;
+
+    REQUIRE(!delocto_set_fen(engine, "8/8/8"));
+    REQUIRE(delocto_set_fen(engine, "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1"));
+    delocto_search(engine, &limits, store_result, &result);
+    delocto_wait(engine);
+
+    REQUIRE(std::string(result.bestMove) == "d1d8");
+    REQUIRE(result.isMate);
+    REQUIRE(result.score == 1);
+    REQUIRE(result.depth == 6);
+    REQUIRE(result.pvLength == 1);
+    REQUIRE(std::string(result.pv[0]) == "d1d8");
+
+    delocto_engine_free(engine);
+
+}
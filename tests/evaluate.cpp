@@ -24,6 +24,31 @@
 #include "./catch.hpp"
 
 #include "../src/evaluate.hpp"
+#include "../src/uci.hpp"
+
+// Both packed values of an evaluation term have to survive all operations, including negative ones
+TEST_CASE("Evaluation terms") {
+    REQUIRE(sizeof(EvalTerm) == 4);
+
+    static const int values[] = { 0, 1, -1, 100, -100, 2500, -2500, INT16_MAX, INT16_MIN };
+    for (const int mg : values) {
+        for (const int eg : values) {
+            const EvalTerm term = V(mg, eg);
+            REQUIRE(term.mg() == mg);
+            REQUIRE(term.eg() == eg);
+        }
+    }
+
+    EvalTerm value;
+    REQUIRE(value == V(0, 0));
+    value += V(-30, 20);
+    value -= V(15, -45);
+    REQUIRE(value == V(-45, 65));
+    REQUIRE(value * -3 == V(135, -195));
+    REQUIRE((V(7, -3) + V(-9, 1)) == V(-2, -2));
+    REQUIRE((V(7, -3) - V(-9, 1)) == V(16, -4));
+    REQUIRE(V(-301, 299) / 3 == V(-100, 99));
+}
 
 // Two evaluation calls for the same position need to return the same value
 TEST_CASE("Evaluation consistency") {
@@ -43,4 +68,113 @@ TEST_CASE("Evaluation consistency") {
             REQUIRE(value1 == value2);
         }
     }
-}
\ No newline at end of file
+}
+
+// A lazy evaluation has to return the full evaluation unless the value is far outside of the window
+TEST_CASE("Lazy evaluation") {
+    static const std::string fens[] = {
+        "q3kb1Q/3p1pr1/p3p2B/1p1bP3/2rN4/P1P2p2/1P4PP/R3R1K1 b - - 1 24",
+        "1k1r3r/ppqn1p2/2pbpn1p/P2pN3/1P1P1P2/2PBP2p/6PP/R1BQ2K1 w - - 0 16",
+        "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12"
+    };
+
+    Board board;
+    for (const std::string fen : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            board.set_fen(fen);
+            const Value value = evaluate(board, 0);
+            bool complete = false;
+
+            REQUIRE(evaluate(board, 0, value - 1, value + 1, complete) == value);
+            REQUIRE(complete);
+
+            // A cached evaluation is always complete
+            Threads.get_thread(0)->evalCache.clear();
+
+            const Value lowValue = evaluate(board, 0, value + 5000, value + 5001, complete);
+            REQUIRE(!complete);
+            REQUIRE(lowValue < value + 5000);
+
+            const Value highValue = evaluate(board, 0, value - 5001, value - 5000, complete);
+            REQUIRE(!complete);
+            REQUIRE(highValue > value - 5000);
+        }
+    }
+}
+
+// The evaluation cache has to return the same value as the full evaluation and must not
+// hold partial evaluations
+TEST_CASE("Evaluation cache") {
+    static const std::string fens[] = {
+        "q3kb1Q/3p1pr1/p3p2B/1p1bP3/2rN4/P1P2p2/1P4PP/R3R1K1 b - - 1 24",
+        "1k1r3r/ppqn1p2/2pbpn1p/P2pN3/1P1P1P2/2PBP2p/6PP/R1BQ2K1 w - - 0 16",
+        "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+        "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12"
+    };
+
+    EvalCache& cache = Threads.get_thread(0)->evalCache;
+    Board board;
+    for (const std::string fen : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            board.set_fen(fen);
+            cache.clear();
+            REQUIRE(cache.probe(board.hashkey()) == NULL);
+
+            const Value value = evaluate(board, 0);
+            EvalEntry * entry = cache.probe(board.hashkey());
+            REQUIRE(entry != NULL);
+            REQUIRE(entry->value == value);
+            REQUIRE(evaluate(board, 0) == value);
+
+            cache.clear();
+            bool complete = true;
+            evaluate(board, 0, value + 5000, value + 5001, complete);
+            REQUIRE(!complete);
+            REQUIRE(cache.probe(board.hashkey()) == NULL);
+        }
+    }
+}
+
+// Imbalance and phase come from the material table for common material configurations and are computed
+// directly for all others, e.g. after underpromotions. Both have to evaluate color flipped positions equally
+TEST_CASE("Material table") {
+    static const std::pair<std::string, std::string> fens[] = {
+        { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1" },
+        { "2r3k1/5pp1/1p2b2p/8/3N4/1P4P1/5PBP/3R2K1 w - - 0 1", "3r2k1/5pbp/1p4p1/3n4/8/1P2B2P/5PP1/2R3K1 b - - 0 1" },
+        { "4k3/pppppppp/8/8/8/8/PPPPPPPP/NNN1K3 w - - 0 1", "nnn1k3/pppppppp/8/8/8/8/PPPPPPPP/4K3 b - - 0 1" },
+        { "3qk3/8/8/8/8/8/PPP5/QQ2K3 w - - 0 1", "qq2k3/ppp5/8/8/8/8/8/3QK3 b - - 0 1" }
+    };
+
+    Board board;
+    for (const auto& [fen, flippedFen] : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            board.set_fen(fen);
+            const Value value = evaluate(board, 0);
+            board.set_fen(flippedFen);
+            REQUIRE(evaluate(board, 0) == value);
+        }
+    }
+}
+
+// The pawn hash table holds a power of two number of cache line sized entries
+TEST_CASE("Pawn hash table") {
+    PawnTable table;
+    REQUIRE(sizeof(PawnEntry) == 64);
+
+    for (const unsigned megabytes : { 1u, 3u, 4u }) {
+        table.set_size(megabytes);
+        REQUIRE((table.size & (table.size - 1)) == 0);
+        REQUIRE(table.size * sizeof(PawnEntry) <= megabytes * MB);
+        REQUIRE(2 * table.size * sizeof(PawnEntry) > megabytes * MB);
+    }
+
+    const uint64_t key = 0x123456789ABCDEF0ULL;
+    REQUIRE(table.probe(key) == NULL);
+    table.store(key, V(12, -34), 1, 2, 3, 4, 5);
+    PawnEntry * entry = table.probe(key);
+    REQUIRE(entry != NULL);
+    REQUIRE(entry->value == V(12, -34));
+    REQUIRE(entry->passedPawns == 3);
+    REQUIRE(table.probe(key + table.size) == NULL);
+}
@@ -21,6 +21,8 @@
   SOFTWARE.
 */
 
+#include <memory>
+
 #include "catch.hpp"
 
 #include "../src/movepick.hpp"
@@ -83,13 +85,15 @@ TEST_CASE("MovePicker") {
 
         Move ttMove = make_move(SQUARE_C5, SQUARE_F5, NORMAL);
 
-        SearchInfo info;
+        std::unique_ptr<ContinuationHistory> continuationHistory(new ContinuationHistory());
+        SearchStackArray stack;
+        stack.clear(continuationHistory->sentinel());
 
-        KillerMoves killers;
         HistoryTable historyTable;
+        CaptureHistoryTable captureHistory;
         CounterMoveTable cmTable;
 
-        MovePicker picker(board, &info, killers, &historyTable, cmTable, 4, ttMove);
+        MovePicker picker(board, stack.root() + 4, &historyTable, &captureHistory, cmTable, ttMove);
 
         Move bestMove;
         unsigned index = 0;
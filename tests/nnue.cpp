@@ -0,0 +1,118 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include "./catch.hpp"
+
+#include "../src/board.hpp"
+#include "../src/evaluate.hpp"
+#include "../src/movegen.hpp"
+
+// Write a network with random parameters in the format expected by NNUE::load
+static void write_random_network(const std::string& filename) {
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> weight(-40, 40);
+    std::ofstream file(filename, std::ios::binary);
+
+    char header[64] = { 'D', 'L', 'N', 'N' };
+    const uint32_t sizes[3] = { 1, NNUE::InputSize, NNUE::HiddenSize };
+    std::memcpy(header + 4, sizes, sizeof(sizes));
+    file.write(header, sizeof(header));
+
+    for (unsigned i = 0; i < NNUE::InputSize * NNUE::HiddenSize + 3 * NNUE::HiddenSize; i++) {
+        const int16_t value = weight(rng);
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    const int32_t outputBias = 100;
+    file.write(reinterpret_cast<const char*>(&outputBias), sizeof(outputBias));
+
+}
+
+// Play all legal moves to the given depth and compare the incrementally updated accumulator
+// with a freshly computed one after every move and every undone move
+static void check_accumulator(Board& board, const unsigned depth) {
+
+    NNUE::Accumulator refreshed;
+    NNUE::refresh(board, refreshed);
+    REQUIRE(std::memcmp(&board.accumulator(), &refreshed, sizeof(NNUE::Accumulator)) == 0);
+
+    if (depth == 0) {
+        return;
+    }
+
+    const MoveList moves = generate_moves<ALL, LEGAL>(board, board.turn());
+    for (unsigned i = 0; i < moves.size(); i++) {
+        board.do_move(moves[i]);
+        check_accumulator(board, depth - 1);
+        board.undo_move();
+        REQUIRE(std::memcmp(&board.accumulator(), &refreshed, sizeof(NNUE::Accumulator)) == 0);
+    }
+
+}
+
+TEST_CASE("NNUE") {
+    static const std::string fens[] = {
+        INITIAL_POSITION_FEN,
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1"
+    };
+
+    const std::string filename = "nnue_test.bin";
+    write_random_network(filename);
+
+    REQUIRE(!NNUE::load("missing.nnue"));
+    REQUIRE(NNUE::load(filename));
+    NNUE::set_enabled(true);
+
+    Board board;
+    for (const std::string fen : fens) {
+        DYNAMIC_SECTION("FEN: " << fen) {
+            board.set_fen(fen);
+            REQUIRE(board.has_accumulator());
+            check_accumulator(board, 2);
+
+            // The network replaces the handcrafted evaluation while it is enabled
+            REQUIRE(evaluate(board, 0) == NNUE::evaluate(board));
+        }
+    }
+
+    // Both perspectives use the same weights, so color flipped positions evaluate equally
+    board.set_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    const Value value = NNUE::evaluate(board);
+    board.set_fen("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
+    REQUIRE(NNUE::evaluate(board) == value);
+
+    NNUE::set_enabled(false);
+    NNUE::unload();
+    std::remove(filename.c_str());
+
+    board.set_fen(INITIAL_POSITION_FEN);
+    REQUIRE(!board.has_accumulator());
+}
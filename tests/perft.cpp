@@ -71,4 +71,52 @@ TEST_CASE("Check perft results") {
         REQUIRE(result == results[f]);
       }
     }
+}
+
+// The move type breakdown should match the well-known perft tables
+TEST_CASE("Check perft breakdown") {
+    SECTION("Initial position") {
+        std::vector<PerftInfo> result = runPerftBreakdown(INITIAL_POSITION_FEN, 4);
+        const PerftInfo& info = result[3];
+
+        REQUIRE(info.nodes == 197281);
+        REQUIRE(info.capturesCount == 1576);
+        REQUIRE(info.enPassantCount == 0);
+        REQUIRE(info.castlesCount == 0);
+        REQUIRE(info.promotionsCount == 0);
+        REQUIRE(info.checksCount == 469);
+        REQUIRE(info.discoveredChecksCount == 0);
+        REQUIRE(info.doubleChecksCount == 0);
+        REQUIRE(info.matesCount == 8);
+    }
+
+    SECTION("Kiwipete") {
+        std::vector<PerftInfo> result = runPerftBreakdown("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 3);
+        const PerftInfo& info = result[2];
+
+        REQUIRE(info.nodes == 97862);
+        REQUIRE(info.capturesCount == 17102);
+        REQUIRE(info.enPassantCount == 45);
+        REQUIRE(info.castlesCount == 3162);
+        REQUIRE(info.promotionsCount == 0);
+        REQUIRE(info.checksCount == 993);
+        REQUIRE(info.discoveredChecksCount == 0);
+        REQUIRE(info.doubleChecksCount == 0);
+        REQUIRE(info.matesCount == 1);
+    }
+
+    SECTION("Position 3") {
+        std::vector<PerftInfo> result = runPerftBreakdown("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5);
+        const PerftInfo& info = result[4];
+
+        REQUIRE(info.nodes == 674624);
+        REQUIRE(info.capturesCount == 52051);
+        REQUIRE(info.enPassantCount == 1165);
+        REQUIRE(info.castlesCount == 0);
+        REQUIRE(info.promotionsCount == 0);
+        REQUIRE(info.checksCount == 52950);
+        REQUIRE(info.discoveredChecksCount == 1292);
+        REQUIRE(info.doubleChecksCount == 3);
+        REQUIRE(info.matesCount == 0);
+    }
 }
\ No newline at end of file
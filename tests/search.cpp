@@ -21,49 +21,71 @@
   SOFTWARE.
 */
 
+#include <memory>
+
 #include "catch.hpp"
 
 #include "../src/search.hpp"
 
-TEST_CASE("KillerMoves") {
-    KillerMoves killers;
-    
+TEST_CASE("SearchStack") {
+    std::unique_ptr<ContinuationHistory> continuationHistory(new ContinuationHistory());
+    SearchStackArray stack;
+    stack.clear(continuationHistory->sentinel());
+
+    SearchStack *ss = stack.root();
+
+    SECTION("should number plies from the root") {
+        REQUIRE(ss->plies == 0);
+        REQUIRE((ss - 1)->plies == -1);
+        REQUIRE((ss - 2)->plies == -2);
+        REQUIRE((ss + 5)->plies == 5);
+    }
+
+    SECTION("should start sentinels without moves or evaluations") {
+        REQUIRE((ss - 1)->currentMove == MOVE_NONE);
+        REQUIRE((ss - 2)->staticEval == VALUE_NONE);
+        REQUIRE((ss - 2)->continuationHistory == continuationHistory->sentinel());
+    }
+
     SECTION("should update killers") {
         Move move1 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
-        killers.update(1, move1);
-        REQUIRE(killers.first(1) == move1);
-        REQUIRE(killers.second(1) == MOVE_NONE);
+        (ss + 1)->update_killers(move1);
+        REQUIRE((ss + 1)->killers[0] == move1);
+        REQUIRE((ss + 1)->killers[1] == MOVE_NONE);
 
         Move move2 = make_move(SQUARE_D2, SQUARE_D4, NORMAL);
-        killers.update(1, move2);
-        REQUIRE(killers.first(1) == move2);
-        REQUIRE(killers.second(1) == move1);
+        (ss + 1)->update_killers(move2);
+        REQUIRE((ss + 1)->killers[0] == move2);
+        REQUIRE((ss + 1)->killers[1] == move1);
     }
 
     SECTION("should clear single ply") {
         Move move1 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
-        killers.update(1, move1);
+        (ss + 1)->update_killers(move1);
 
         Move move2 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
-        killers.update(3, move2);
+        (ss + 3)->update_killers(move2);
 
-        killers.clear(1);
+        (ss + 1)->clear_killers();
 
-        REQUIRE(killers.first(1) == MOVE_NONE);
-        REQUIRE(killers.first(3) == move2);
+        REQUIRE((ss + 1)->killers[0] == MOVE_NONE);
+        REQUIRE((ss + 3)->killers[0] == move2);
     }
 
     SECTION("should clear all") {
         Move move1 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
-        killers.update(1, move1);
+        (ss + 1)->update_killers(move1);
+        (ss + 1)->currentMove = move1;
 
         Move move2 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
-        killers.update(3, move2);
+        (ss + 3)->update_killers(move2);
 
-        killers.clear();
+        stack.clear(continuationHistory->sentinel());
 
-        REQUIRE(killers.first(1) == MOVE_NONE);
-        REQUIRE(killers.first(3) == MOVE_NONE);
+        REQUIRE((ss + 1)->killers[0] == MOVE_NONE);
+        REQUIRE((ss + 1)->currentMove == MOVE_NONE);
+        REQUIRE((ss + 3)->killers[0] == MOVE_NONE);
+        REQUIRE((ss + 3)->plies == 3);
     }
 }
 
@@ -89,6 +111,50 @@ TEST_CASE("HistoryTable") {
     }
 }
 
+TEST_CASE("ContinuationHistory") {
+    std::unique_ptr<ContinuationHistory> history(new ContinuationHistory());
+
+    SECTION("should keep separate tables per earlier move") {
+        history->get(WHITE, KNIGHT, SQUARE_F3)->update_score(BLACK, PAWN, SQUARE_D5, 32);
+
+        REQUIRE(history->get(WHITE, KNIGHT, SQUARE_F3)->get_score(BLACK, PAWN, SQUARE_D5) == 1024);
+        REQUIRE(history->get(WHITE, KNIGHT, SQUARE_C3)->get_score(BLACK, PAWN, SQUARE_D5) == 0);
+        REQUIRE(history->get(BLACK, KNIGHT, SQUARE_F3)->get_score(BLACK, PAWN, SQUARE_D5) == 0);
+        REQUIRE(history->sentinel()->get_score(BLACK, PAWN, SQUARE_D5) == 0);
+    }
+
+    SECTION("should clear all") {
+        history->get(WHITE, KNIGHT, SQUARE_F3)->update_score(BLACK, PAWN, SQUARE_D5, 32);
+        history->get(BLACK, QUEEN, SQUARE_H4)->update_score(WHITE, KING, SQUARE_E2, -32);
+
+        history->clear();
+
+        REQUIRE(history->get(WHITE, KNIGHT, SQUARE_F3)->get_score(BLACK, PAWN, SQUARE_D5) == 0);
+        REQUIRE(history->get(BLACK, QUEEN, SQUARE_H4)->get_score(WHITE, KING, SQUARE_E2) == 0);
+    }
+}
+
+TEST_CASE("CaptureHistoryTable") {
+    CaptureHistoryTable table;
+
+    SECTION("should update score per captured piece") {
+        table.update_score(WHITE, KNIGHT, SQUARE_D5, PAWN, 32);
+
+        REQUIRE(table.get_score(WHITE, KNIGHT, SQUARE_D5, PAWN) == 1024);
+        REQUIRE(table.get_score(WHITE, KNIGHT, SQUARE_D5, BISHOP) == 0);
+    }
+
+    SECTION("should clear all") {
+        table.update_score(WHITE, KNIGHT, SQUARE_D5, PAWN, 32);
+        table.update_score(BLACK, QUEEN, SQUARE_A1, ROOK, -32);
+
+        table.clear();
+
+        REQUIRE(table.get_score(WHITE, KNIGHT, SQUARE_D5, PAWN) == 0);
+        REQUIRE(table.get_score(BLACK, QUEEN, SQUARE_A1, ROOK) == 0);
+    }
+}
+
 TEST_CASE("CounterMoveTable") {
     CounterMoveTable table;
 
@@ -113,4 +179,93 @@ TEST_CASE("CounterMoveTable") {
         REQUIRE(table.get_move(BLACK, BISHOP, SQUARE_A2) == MOVE_NONE);
         REQUIRE(table.get_move(WHITE, QUEEN, SQUARE_D5) == MOVE_NONE);
     }
-}
\ No newline at end of file
+}
+TEST_CASE("PrincipalVariation") {
+    PrincipalVariation pv;
+
+    SECTION("should build lines from child rows") {
+        const Move move1 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
+        const Move move2 = make_move(SQUARE_E7, SQUARE_E5, NORMAL);
+        const Move move3 = make_move(SQUARE_G1, SQUARE_F3, NORMAL);
+
+        pv.reset(0);
+        pv.reset(1);
+        pv.reset(2);
+        pv.reset(3);
+        pv.update(2, move3);
+        pv.update(1, move2);
+        pv.update(0, move1);
+
+        REQUIRE(pv.length() == 3);
+        REQUIRE(pv.best() == move1);
+        REQUIRE(pv.get_move(1) == move2);
+        REQUIRE(pv.get_move(2) == move3);
+    }
+
+    SECTION("should drop the line of a reset child row") {
+        const Move move1 = make_move(SQUARE_D2, SQUARE_D4, NORMAL);
+        const Move move2 = make_move(SQUARE_D7, SQUARE_D5, NORMAL);
+
+        pv.reset(2);
+        pv.update(1, move2);
+        pv.update(0, move1);
+        REQUIRE(pv.length() == 2);
+
+        pv.reset(1);
+        pv.update(0, move1);
+        REQUIRE(pv.length() == 1);
+        REQUIRE(pv.best() == move1);
+    }
+}
+
+// The static exchange evaluation should find the material balance of the best capture sequence
+TEST_CASE("Static exchange evaluation") {
+    Board board;
+
+    SECTION("Undefended pawn") {
+        board.set_fen("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1");
+        const Move move = make_move(SQUARE_E1, SQUARE_E5, NORMAL);
+
+        REQUIRE(board.see(move) == SeeMaterial[PAWN]);
+        REQUIRE(board.see_ge(move, SeeMaterial[PAWN]));
+        REQUIRE(!board.see_ge(move, SeeMaterial[PAWN] + 1));
+    }
+
+    SECTION("Pawn defended by x-ray attackers") {
+        board.set_fen("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1");
+        const Move move = make_move(SQUARE_D3, SQUARE_E5, NORMAL);
+
+        REQUIRE(board.see(move) == SeeMaterial[PAWN] - SeeMaterial[KNIGHT]);
+        REQUIRE(!board.see_ge(move, 0));
+    }
+
+    SECTION("King cannot capture a defended piece") {
+        board.set_fen("2r1k3/8/b7/8/2P5/3K4/8/8 b - - 0 1");
+        const Move move = make_move(SQUARE_C8, SQUARE_C4, NORMAL);
+
+        REQUIRE(board.see(move) == SeeMaterial[PAWN]);
+        REQUIRE(board.see_ge(move, 0));
+    }
+
+    SECTION("Threshold test should agree with the full evaluation") {
+        static const std::string fens[] = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q2/PPPBBPPP/R3K2R w KQkq - 0 1",
+            "2kr1b1r/1pp2pp1/p1n1bq2/P2pp3/1P2Pn1p/2PP1N1P/1BQN1PP1/R3KB1R b KQ - 2 12",
+            "r1bq3r/3nnkp1/2pbpp2/p2p4/P4P2/2N1PN1p/1BPPBRPP/R2Q2K1 w - - 0 12",
+            "r4rk1/ppb2ppp/3q1B2/3pp3/P5b1/1BNP1n2/1PP2PPP/R2Q1RK1 w - - 0 14",
+            "8/1Q4kp/6p1/P3p1nb/1p1qP1r1/8/2Pp1P2/3R1R1K b - - 1 48"
+        };
+        static const Value thresholds[] = { -500, -100, -1, 0, 1, 100, 500 };
+
+        for (const std::string fen : fens) {
+            board.set_fen(fen);
+            for (const Move move : generate_moves<ALL, PSEUDO_LEGAL>(board, board.turn())) {
+                const Value see = board.see(move);
+                for (const Value threshold : thresholds) {
+                    INFO(fen << " " << move_to_string(move) << " see " << see << " threshold " << threshold);
+                    REQUIRE(board.see_ge(move, threshold) == (see >= threshold));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,54 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "./catch.hpp"
+
+#include "../src/trace.hpp"
+#include "../src/move.hpp"
+
+TEST_CASE("Search trace") {
+
+    const std::string filename = "search_trace_test.bin";
+    const Move e2e4 = make_move(SQUARE_E2, SQUARE_E4, NORMAL);
+    const Move d2d4 = make_move(SQUARE_D2, SQUARE_D4, NORMAL);
+
+    // A root node with two children, in post-order
+    {
+        TraceWriter writer;
+        REQUIRE(writer.open(filename));
+        writer.write({ 5, e2e4, -100, 100, 20, 1, 1, TRACE_CUT, EXIT_BETA_CUTOFF });
+        writer.write({ 2, d2d4, -100, 100, 10, 1, 1, TRACE_ALL, EXIT_TT_CUTOFF });
+        writer.write({ 8, MOVE_NONE, -100, 100, 20, 0, 2, TRACE_PV, EXIT_SEARCHED });
+    }
+
+    std::stringstream ss;
+    analyze_trace(filename, 1, ss);
+    const std::string summary = ss.str();
+
+    REQUIRE(summary.find("Records: 3") != std::string::npos);
+    REQUIRE(summary.find("e2e4") != std::string::npos);
+    REQUIRE(summary.find("e2e4") < summary.find("d2d4")); // Larger subtree is listed first
+
+    std::remove(filename.c_str());
+
+}
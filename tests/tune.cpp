@@ -0,0 +1,167 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include "./catch.hpp"
+
+#include "../src/dataset.hpp"
+#include "../src/tune.hpp"
+
+static const std::string TuneFens[] = {
+    "q3kb1Q/3p1pr1/p3p2B/1p1bP3/2rN4/P1P2p2/1P4PP/R3R1K1 b - - 1 24",
+    "1k1r3r/ppqn1p2/2pbpn1p/P2pN3/1P1P1P2/2PBP2p/6PP/R1BQ2K1 w - - 0 16",
+    "r3kb1r/1p1n1pp1/p1p1pnp1/2Pp4/1P1P1P2/2N1P3/1P1B2PP/R3KB1R b KQkq - 0 14",
+    "r1bqk2r/p5pp/2pbp3/5pB1/3P4/5N2/PP3PPP/R2Q1RK1 b kq - 3 12",
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+    "8/8/4k3/8/2p5/8/B2K4/8 w - - 0 60",
+    "6k1/5ppp/8/8/8/8/r4PPP/1R4K1 w - - 0 30"
+};
+
+TEST_CASE("Dataset") {
+
+    const std::string filename = "dataset_test.bin";
+
+    Dataset::GameResult result;
+    std::string fen;
+
+    // Supported result labels
+    REQUIRE(Dataset::parse_labelled_line(TuneFens[0] + " [1.0]", fen, result));
+    REQUIRE(fen == TuneFens[0]);
+    REQUIRE(result == Dataset::RESULT_WHITE_WIN);
+    REQUIRE(Dataset::parse_labelled_line("8/8/4k3/8/2p5/8/B2K4/8 w - - c9 \"1/2-1/2\";", fen, result));
+    REQUIRE(fen == "8/8/4k3/8/2p5/8/B2K4/8 w - -");
+    REQUIRE(result == Dataset::RESULT_DRAW);
+    REQUIRE(Dataset::parse_labelled_line(TuneFens[1] + " acd 0; c9 \"0-1\";", fen, result));
+    REQUIRE(result == Dataset::RESULT_BLACK_WIN);
+    REQUIRE(Dataset::parse_labelled_line(TuneFens[1] + " id \"pos 1\"; [0.5]", fen, result));
+    REQUIRE(result == Dataset::RESULT_DRAW);
+    REQUIRE(!Dataset::parse_labelled_line(TuneFens[1], fen, result));
+
+    // Numbers of other operations are not game results
+    REQUIRE(!Dataset::parse_labelled_line(TuneFens[1] + " id \"pos 1\";", fen, result));
+    REQUIRE(!Dataset::parse_labelled_line(TuneFens[1] + " acd 0;", fen, result));
+    REQUIRE(!Dataset::parse_labelled_line(TuneFens[1] + " c9 \"1\";", fen, result));
+    REQUIRE(!Dataset::parse_labelled_line(TuneFens[1] + " 1-0 [draw]", fen, result));
+    REQUIRE(!Dataset::parse_labelled_line("8/8/8/8/8/8/8/8 w - - 0 1 1-0", fen, result));
+
+    // Positions survive packing, writing and reading
+    Board board;
+    {
+        Dataset::Writer writer;
+        REQUIRE(writer.open(filename));
+        for (const std::string& fen : TuneFens) {
+            board.set_fen(fen);
+            writer.write(Dataset::pack(board, Dataset::RESULT_DRAW, -25));
+        }
+    }
+
+    Dataset::Reader reader;
+    REQUIRE(reader.open(filename));
+    REQUIRE(reader.size() == 7);
+
+    for (unsigned i = 0; i < reader.size(); i++) {
+        REQUIRE(board.from_packed(reader[i]));
+        REQUIRE(board.get_fen() == TuneFens[i]);
+        REQUIRE(reader[i].result == Dataset::RESULT_DRAW);
+        REQUIRE(reader[i].score == -25);
+    }
+
+    reader.close();
+
+    // Text files are converted in parallel, keeping the order of the positions
+    const std::string textFilename = "dataset_test.epd";
+    {
+        std::ofstream text(textFilename);
+        for (const std::string& fen : TuneFens) {
+            text << fen << " c9 \"1/2-1/2\";" << std::endl;
+        }
+        text << "invalid" << std::endl;
+    }
+
+    uint64_t skipped;
+    REQUIRE(Dataset::convert(textFilename, filename, 3, skipped) == 7);
+    REQUIRE(skipped == 1);
+    REQUIRE(reader.open(filename));
+    REQUIRE(reader.size() == 7);
+
+    for (unsigned i = 0; i < reader.size(); i++) {
+        REQUIRE(board.from_packed(reader[i]));
+        REQUIRE(board.get_fen() == TuneFens[i]);
+        REQUIRE(reader[i].result == Dataset::RESULT_DRAW);
+    }
+
+    reader.close();
+    std::remove(filename.c_str());
+    std::remove(textFilename.c_str());
+
+}
+
+#ifdef EVAL_TUNE
+TEST_CASE("Evaluation tuner") {
+
+    const std::string filename = "tune_test.bin";
+    static const int TempoBonus = 12;
+
+    Board board;
+    {
+        Dataset::Writer writer;
+        REQUIRE(writer.open(filename));
+        for (const std::string& fen : TuneFens) {
+            board.set_fen(fen);
+            const int eval = evaluate(board, 0);
+            writer.write(Dataset::pack(board, (board.turn() == WHITE) == (eval > 0) ? Dataset::RESULT_WHITE_WIN : Dataset::RESULT_BLACK_WIN, VALUE_NONE));
+        }
+    }
+
+    Dataset::Reader reader;
+    REQUIRE(reader.open(filename));
+
+    for (const unsigned threads : { 1, 3 }) {
+        DYNAMIC_SECTION("Threads: " << threads) {
+
+            Tune::Tuner tuner;
+            REQUIRE(tuner.load(reader, threads) == 7);
+
+            // The traces reproduce the evaluation with the current parameters
+            unsigned index = 0;
+            for (unsigned shard = 0; shard < threads; shard++) {
+                for (unsigned i = 0; i < 7 * (shard + 1) / threads - 7 * shard / threads; i++, index++) {
+                    board.set_fen(TuneFens[index]);
+                    const int eval = (evaluate(board, 0) - TempoBonus) * (board.turn() == WHITE ? 1 : -1);
+                    REQUIRE(std::abs(tuner.evaluate(shard, i, tuner.parameters()) - eval) <= 2);
+                }
+            }
+
+            // Gradient descent lowers the error
+            const double loss = tuner.loss(tuner.parameters());
+            std::stringstream ss;
+            tuner.run(20, 1.0, ss);
+            REQUIRE(tuner.loss(tuner.parameters()) < loss);
+
+        }
+    }
+
+    reader.close();
+    std::remove(filename.c_str());
+
+}
+#endif
@@ -0,0 +1,242 @@
+/*
+  Delocto Chess Engine
+  Copyright (c) 2018-2021 Moritz Terink
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in all
+  copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  SOFTWARE.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include "./catch.hpp"
+
+#include "../src/io.hpp"
+#include "../src/thread.hpp"
+#include "../src/timeman.hpp"
+#include "../src/uci.hpp"
+
+// Stream buffer which records the lines written by the output thread together with their arrival
+// time. An optional delay per line simulates a slow pipe
+class LineRecorder : public std::streambuf {
+
+    public:
+
+        explicit LineRecorder(const Duration d = 0) : delay(d) {}
+
+        // Wait until the given number of lines starting with the prefix have arrived
+        // and return the arrival time of the last one
+        bool wait_for(const std::string& prefix, const unsigned count, TimePoint& arrival) {
+
+            const TimePoint start = Clock::now();
+
+            while (get_time_elapsed(start) < 5000) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    unsigned found = 0;
+                    for (const auto& line : lines) {
+                        if (line.first.rfind(prefix, 0) == 0 && ++found == count) {
+                            arrival = line.second;
+                            return true;
+                        }
+                    }
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+
+            return false;
+
+        }
+
+        unsigned count(const std::string& prefix) {
+
+            std::lock_guard<std::mutex> lock(mutex);
+
+            return std::count_if(lines.begin(), lines.end(), [&](const auto& line) { return line.first.rfind(prefix, 0) == 0; });
+
+        }
+
+    protected:
+
+        int overflow(const int c) override {
+            if (c != traits_type::eof()) {
+                put(char(c));
+            }
+            return c;
+        }
+
+        std::streamsize xsputn(const char* s, const std::streamsize n) override {
+            for (std::streamsize i = 0; i < n; i++) {
+                put(s[i]);
+            }
+            return n;
+        }
+
+    private:
+
+        void put(const char c) {
+            if (c != '\n') {
+                current += c;
+                return;
+            }
+            if (delay) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            lines.emplace_back(current, Clock::now());
+            current.clear();
+        }
+
+        Duration delay;
+        std::string current; // Only accessed by the output thread
+        std::vector<std::pair<std::string, TimePoint>> lines;
+        std::mutex mutex;
+
+};
+
+static double milliseconds_between(const TimePoint start, const TimePoint end) {
+
+    return std::chrono::duration<double, std::milli>(end - start).count();
+
+}
+
+// Messages of every producer leave the queue in the order they were sent
+TEST_CASE("Output queue") {
+
+    static constexpr unsigned Producers = 4;
+    static constexpr unsigned MessagesPerProducer = 20000;
+
+    IO::OutputQueue queue;
+    std::vector<std::thread> producers;
+
+    for (unsigned p = 0; p < Producers; p++) {
+        producers.emplace_back([&queue, p] {
+            for (unsigned i = 0; i < MessagesPerProducer; i++) {
+                IO::Message* message = new IO::Message();
+                message->text = std::to_string(p) + ' ' + std::to_string(i);
+                queue.push(message);
+            }
+        });
+    }
+
+    unsigned received = 0;
+    std::vector<int> last(Producers, -1);
+
+    while (received < Producers * MessagesPerProducer) {
+        IO::Message* message = queue.pop();
+        if (!message) {
+            std::this_thread::yield();
+            continue;
+        }
+        std::stringstream ss(message->text);
+        unsigned producer;
+        int index;
+        ss >> producer >> index;
+        REQUIRE(index == last[producer] + 1);
+        last[producer] = index;
+        received++;
+        delete message;
+    }
+
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    REQUIRE(queue.pop() == nullptr);
+
+}
+
+// The search does not wait for a slow consumer of its output
+TEST_CASE("Output thread") {
+
+    LineRecorder recorder(100);
+    std::ostream stream(&recorder);
+    Board board;
+
+    IO::start(stream);
+
+    UCI::parse_uci_input("position startpos", board);
+    UCI::parse_uci_input("go depth 6", board);
+    Threads.wait_until_finished();
+
+    // The best move has been sent, but the output thread is still writing
+    REQUIRE(recorder.count("bestmove") == 0);
+
+    IO::flush();
+    REQUIRE(recorder.count("info depth") == 6);
+    REQUIRE(recorder.count("bestmove") == 1);
+
+    IO::stop();
+
+}
+
+// Commands are answered quickly while all threads are searching
+TEST_CASE("Command latency") {
+
+    LineRecorder recorder;
+    std::ostream stream(&recorder);
+    Board board;
+    TimePoint sent, arrival;
+
+    Threads.resize(4);
+    IO::start(stream);
+
+    UCI::parse_uci_input("position startpos", board);
+    UCI::parse_uci_input("go infinite", board);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    double readyLatency = 0;
+    for (unsigned i = 1; i <= 10; i++) {
+        sent = Clock::now();
+        UCI::parse_uci_input("isready", board);
+        REQUIRE(recorder.wait_for("readyok", i, arrival));
+        readyLatency = std::max(readyLatency, milliseconds_between(sent, arrival));
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    sent = Clock::now();
+    UCI::parse_uci_input("stop", board);
+    REQUIRE(recorder.wait_for("bestmove", 1, arrival));
+    const double stopLatency = milliseconds_between(sent, arrival);
+
+    // The best move of a ponder search is only sent after ponderhit
+    UCI::parse_uci_input("go ponder depth 4", board);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    REQUIRE(recorder.count("bestmove") == 1);
+
+    sent = Clock::now();
+    UCI::parse_uci_input("ponderhit", board);
+    REQUIRE(recorder.wait_for("bestmove", 2, arrival));
+    const double ponderhitLatency = milliseconds_between(sent, arrival);
+
+    Threads.wait_until_finished();
+    IO::stop();
+    Threads.resize(ThreadsOption.get_value());
+
+    std::cout << "Latency under search load (ms): isready " << readyLatency << " (max of 10), stop " << stopLatency << ", ponderhit " << ponderhitLatency << std::endl;
+
+    REQUIRE(readyLatency < 250);
+    REQUIRE(stopLatency < 250);
+    REQUIRE(ponderhitLatency < 250);
+
+}